@@ -0,0 +1,421 @@
+#include "Diagnostics.h"
+#include "Mx.h"
+#include "Parser.h"
+#include "Planner.h"
+#include "Random.h"
+#include "SourceManager.h"
+#include "Stats.h"
+#include "Tokenizer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr usz BENCH_MIN_SIZE = 2;
+static constexpr usz BENCH_DEFAULT_MAX_SIZE = 4096;
+static constexpr f64 BENCH_DEFAULT_MIN_TIME_MS = 200.0;
+static constexpr usz BENCH_MAX_SAMPLES = 15;
+// Cases where a single run takes longer than the whole time budget still get this many samples
+static constexpr usz BENCH_MIN_SAMPLES = 3;
+static constexpr usz BENCH_OPERAND_COUNT = 4;
+// Deep enough to show parse time growing with each level of nesting rather than with the size of the program
+static constexpr usz BENCH_MAX_NESTING = 24;
+
+// Operands of a single kernel at a single size, the matrices are laid out like the planner lays them out in the slab
+typedef struct BenchCase {
+	usz Size;
+	Mx* Left;
+	Mx* Right;
+	Mx* Out;
+	Mx* Temp;
+	void* Memory[BENCH_OPERAND_COUNT];
+	// Generated program for the parse benchmark
+	char* Source;
+	usz SourceLength;
+} BenchCase;
+
+typedef struct BenchKernel {
+	const char* Name;
+	void (*Setup)(BenchCase* bench);
+	void (*Run)(BenchCase* bench);
+	// Floating point operations and the bytes that have to move at least once for one run, not counting cache misses
+	u64 (*Flops)(const BenchCase* bench);
+	u64 (*Bytes)(const BenchCase* bench);
+	// Sizes double from BENCH_MIN_SIZE unless a step is given, both sweeps stop at --max-size at the latest
+	usz SweepStep;
+	usz SweepMax;
+} BenchKernel;
+
+typedef struct BenchResult {
+	usz Iterations;
+	usz Samples;
+	f64 MinNs;
+	f64 MedianNs;
+	f64 MeanNs;
+	f64 StdDevNs;
+} BenchResult;
+
+// Keeps results the compiler can't see being used alive
+static volatile f64 g_benchSink = 0;
+
+static Mx* BenchAllocMx(BenchCase* bench, usz slot, MxShape shape)
+{
+	bench->Memory[slot] = malloc(MxBytes(shape) + PLANNER_ALIGNMENT - 1);
+	if (!bench->Memory[slot]) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	Mx* mx = MxPlace((void*)AlignUp((usz)bench->Memory[slot], PLANNER_ALIGNMENT), shape);
+
+	for (usz r = 0; r < shape.Height; ++r) {
+		RandomFillUniform(mx->Data + (r * mx->Stride), shape.Width);
+	}
+
+	return mx;
+}
+
+// The diagonal dominates every row, so det and inv never hit a singular matrix
+static void BenchSetupSquare(BenchCase* bench, usz tempWidth)
+{
+	usz n = bench->Size;
+
+	bench->Left = BenchAllocMx(bench, 0, (MxShape) { n, n });
+	bench->Right = BenchAllocMx(bench, 1, (MxShape) { n, n });
+	bench->Out = BenchAllocMx(bench, 2, (MxShape) { n, n });
+
+	if (tempWidth > 0) {
+		bench->Temp = BenchAllocMx(bench, 3, (MxShape) { n, tempWidth });
+	}
+
+	for (usz i = 0; i < n; ++i) {
+		bench->Left->Data[(i * bench->Left->Stride) + i] += (f64)n;
+	}
+}
+
+static void BenchSetupBinary(BenchCase* bench) { BenchSetupSquare(bench, 0); }
+static void BenchSetupDet(BenchCase* bench) { BenchSetupSquare(bench, bench->Size); }
+static void BenchSetupInv(BenchCase* bench) { BenchSetupSquare(bench, 2 * bench->Size); }
+
+// The generated program is sized up front, appending never runs out of room
+static void BenchAppend(BenchCase* bench, const char* text)
+{
+	usz length = strlen(text);
+	memcpy(bench->Source + bench->SourceLength, text, length);
+	bench->SourceLength += length;
+	bench->Source[bench->SourceLength] = '\0';
+}
+
+static void BenchAllocSource(BenchCase* bench, usz capacity)
+{
+	bench->Source = (char*)malloc(capacity);
+	if (!bench->Source) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	bench->SourceLength = 0;
+	bench->Source[0] = '\0';
+}
+
+// A program of `Size` statements mixing literals, operators, calls and nested blocks
+static void BenchSetupParse(BenchCase* bench)
+{
+	static const char* const STATEMENTS[] = {
+		"let a = [1 2 3][4 5 6] * <<1 2 3>> + 0.5\n",
+		"let b: 2x2 = ([1 0][0 1] + 2) ^ 3 - ident(2)\n",
+		"if a[1 1] > 2 { a[1] = a[2] / 4 } else { a[2] = -a[1] }\n",
+		"while det(b) < 10 { b = b * 2 }\n",
+	};
+	static constexpr usz STATEMENT_COUNT = sizeof(STATEMENTS) / sizeof(STATEMENTS[0]);
+
+	usz capacity = 1;
+	for (usz i = 0; i < bench->Size; ++i) {
+		capacity += strlen(STATEMENTS[i % STATEMENT_COUNT]);
+	}
+
+	BenchAllocSource(bench, capacity);
+	for (usz i = 0; i < bench->Size; ++i) {
+		BenchAppend(bench, STATEMENTS[i % STATEMENT_COUNT]);
+	}
+}
+
+// `Size` levels of ifs and whiles alternating, every level holding a statement next to the next level
+static void BenchSetupParseNested(BenchCase* bench)
+{
+	static const char* const OPEN = "let a = [1 2][3 4]\n";
+	static const char* const IF = "if a[1 1] > 0 {\n";
+	static const char* const WHILE = "while a[1 1] < 0 {\n";
+	static const char* const STATEMENT = "a = a * 2 + [1 0][0 1]\n";
+	static const char* const CLOSE = "}\n";
+
+	BenchAllocSource(bench, strlen(OPEN) + (bench->Size * (strlen(WHILE) + strlen(STATEMENT) + strlen(CLOSE))) + 1);
+
+	BenchAppend(bench, OPEN);
+	for (usz i = 0; i < bench->Size; ++i) {
+		BenchAppend(bench, i % 2 == 0 ? IF : WHILE);
+		BenchAppend(bench, STATEMENT);
+	}
+
+	for (usz i = 0; i < bench->Size; ++i) {
+		BenchAppend(bench, CLOSE);
+	}
+}
+
+static void BenchRunAdd(BenchCase* bench) { MxAdd(bench->Left, bench->Right, bench->Out); }
+static void BenchRunMultiply(BenchCase* bench) { MxMultiply(bench->Left, bench->Right, bench->Out); }
+static void BenchRunTranspose(BenchCase* bench) { MxTranspose(bench->Left, bench->Out); }
+static void BenchRunDet(BenchCase* bench) { g_benchSink = g_benchSink + MxDeterminant(bench->Left, bench->Temp); }
+
+static void BenchRunInv(BenchCase* bench)
+{
+	if (MxInverse(bench->Left, bench->Out, bench->Temp)) {
+		DIAG_PANIC_ON_ERR(ResInvalidOperand);
+	}
+}
+
+// Tokenizes and parses the generated program from scratch, the way a run without a cache does
+static void BenchRunParse(BenchCase* bench)
+{
+	g_source.FileName = "bench.mx";
+	g_source.Source = bench->Source;
+	g_source.SourceLength = bench->SourceLength;
+
+	TokenizerInit();
+	ParserInit();
+	ParserParse();
+
+	if (DiagReport() > 0) {
+		DIAG_PANIC_ON_ERR(ResInvalidToken);
+	}
+
+	g_benchSink = g_benchSink + (f64)g_parser.Nodes.Count;
+
+	ParserDeinit();
+	TokenizerDeinit();
+
+	g_source = (Source) { 0 };
+}
+
+static u64 BenchFlopsNone(const BenchCase* bench)
+{
+	(void)bench;
+	return 0;
+}
+
+static u64 BenchFlopsElementwise(const BenchCase* bench) { return (u64)bench->Size * bench->Size; }
+static u64 BenchFlopsMultiply(const BenchCase* bench) { return 2 * (u64)bench->Size * bench->Size * bench->Size; }
+
+// Same counts --estimate uses
+static u64 BenchFlopsDet(const BenchCase* bench) { return 2 * (u64)bench->Size * bench->Size * bench->Size / 3; }
+static u64 BenchFlopsInv(const BenchCase* bench) { return 4 * (u64)bench->Size * bench->Size * bench->Size; }
+
+static u64 BenchBytesBinary(const BenchCase* bench) { return 3 * (u64)bench->Size * bench->Size * sizeof(f64); }
+static u64 BenchBytesUnary(const BenchCase* bench) { return 2 * (u64)bench->Size * bench->Size * sizeof(f64); }
+static u64 BenchBytesDet(const BenchCase* bench) { return (u64)bench->Size * bench->Size * sizeof(f64); }
+
+// The parse rate is in bytes of source
+static u64 BenchBytesParse(const BenchCase* bench) { return bench->SourceLength; }
+
+static const BenchKernel BENCH_KERNELS[] = {
+	{ "add", BenchSetupBinary, BenchRunAdd, BenchFlopsElementwise, BenchBytesBinary, 0, 0 },
+	{ "multiply", BenchSetupBinary, BenchRunMultiply, BenchFlopsMultiply, BenchBytesBinary, 0, 0 },
+	{ "transpose", BenchSetupBinary, BenchRunTranspose, BenchFlopsNone, BenchBytesUnary, 0, 0 },
+	{ "det", BenchSetupDet, BenchRunDet, BenchFlopsDet, BenchBytesDet, 0, 0 },
+	{ "inv", BenchSetupInv, BenchRunInv, BenchFlopsInv, BenchBytesUnary, 0, 0 },
+	{ "parse", BenchSetupParse, BenchRunParse, BenchFlopsNone, BenchBytesParse, 0, 0 },
+	{ "parse-nested", BenchSetupParseNested, BenchRunParse, BenchFlopsNone, BenchBytesParse, 1, BENCH_MAX_NESTING },
+};
+
+static constexpr usz BENCH_KERNEL_COUNT = sizeof(BENCH_KERNELS) / sizeof(BENCH_KERNELS[0]);
+
+static void BenchDeinitCase(BenchCase* bench)
+{
+	for (usz i = 0; i < BENCH_OPERAND_COUNT; ++i) {
+		free(bench->Memory[i]);
+	}
+
+	free(bench->Source);
+}
+
+static u64 BenchTime(const BenchKernel* kernel, BenchCase* bench, usz iterations)
+{
+	u64 start = StatsNow();
+	for (usz i = 0; i < iterations; ++i) {
+		kernel->Run(bench);
+	}
+
+	return StatsNow() - start;
+}
+
+static int BenchCompareF64(const void* left, const void* right)
+{
+	f64 a = *(const f64*)left;
+	f64 b = *(const f64*)right;
+
+	return (a > b) - (a < b);
+}
+
+// Warms up by doubling the iteration count until a sample fills its share of the time budget, then takes the samples
+static BenchResult BenchMeasure(const BenchKernel* kernel, BenchCase* bench, f64 minTimeNs)
+{
+	BenchResult result = { .Iterations = 1, .Samples = BENCH_MAX_SAMPLES };
+	f64 sampleNs = minTimeNs / (f64)BENCH_MAX_SAMPLES;
+
+	u64 elapsedNs = BenchTime(kernel, bench, result.Iterations);
+	while ((f64)elapsedNs < sampleNs) {
+		result.Iterations *= 2;
+		elapsedNs = BenchTime(kernel, bench, result.Iterations);
+	}
+
+	// Kernels slower than a sample even with a single iteration only get as many samples as fit the budget
+	if (result.Iterations == 1) {
+		usz fitting = (usz)(minTimeNs / (f64)(elapsedNs > 0 ? elapsedNs : 1));
+		result.Samples = fitting < BENCH_MIN_SAMPLES ? BENCH_MIN_SAMPLES : fitting < BENCH_MAX_SAMPLES ? fitting : BENCH_MAX_SAMPLES;
+	}
+
+	f64 samples[BENCH_MAX_SAMPLES];
+	for (usz i = 0; i < result.Samples; ++i) {
+		samples[i] = (f64)BenchTime(kernel, bench, result.Iterations) / (f64)result.Iterations;
+		result.MeanNs += samples[i];
+	}
+
+	qsort(samples, result.Samples, sizeof(f64), BenchCompareF64);
+
+	result.MeanNs /= (f64)result.Samples;
+	result.MinNs = samples[0];
+	result.MedianNs = samples[result.Samples / 2];
+	if (result.Samples % 2 == 0) {
+		result.MedianNs = (samples[(result.Samples / 2) - 1] + result.MedianNs) / 2;
+	}
+
+	for (usz i = 0; i < result.Samples; ++i) {
+		result.StdDevNs += (samples[i] - result.MeanNs) * (samples[i] - result.MeanNs);
+	}
+
+	result.StdDevNs = sqrt(result.StdDevNs / (f64)(result.Samples - 1));
+
+	return result;
+}
+
+static void BenchPrint(const BenchKernel* kernel, const BenchCase* bench, const BenchResult* result, bool json, bool first)
+{
+	usz size = bench->Size;
+
+	// Rates come from the median, which a few disturbed samples don't move
+	f64 gflops = (f64)kernel->Flops(bench) / result->MedianNs;
+	f64 gbps = (f64)kernel->Bytes(bench) / result->MedianNs;
+
+	if (json) {
+		printf("%s\n    {\"kernel\":\"%s\",\"size\":%zu,\"iterations\":%zu,\"samples\":%zu,\"minNs\":%.1f,\"medianNs\":%.1f,"
+			   "\"meanNs\":%.1f,\"stdDevNs\":%.1f,\"gflops\":%.3f,\"gbps\":%.3f}",
+			first ? "" : ",", kernel->Name, size, result->Iterations, result->Samples, result->MinNs, result->MedianNs, result->MeanNs,
+			result->StdDevNs, gflops, gbps);
+	} else {
+		printf("%-12s %6zu %10zu %14.1f %14.1f %14.1f %12.1f %10.3f %10.3f\n", kernel->Name, size, result->Iterations, result->MinNs,
+			result->MedianNs, result->MeanNs, result->StdDevNs, gflops, gbps);
+	}
+
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* kernelName = nullptr;
+	usz maxSize = BENCH_DEFAULT_MAX_SIZE;
+	f64 minTimeMs = BENCH_DEFAULT_MIN_TIME_MS;
+	bool json = false;
+
+	for (i32 i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--kernel") == 0 || strcmp(argv[i], "--max-size") == 0 || strcmp(argv[i], "--min-time") == 0) {
+			if (i + 1 >= argc) {
+				fprintf(stderr, "The '%s' option requires a value\n", argv[i]);
+				return 1;
+			}
+
+			const char* option = argv[i++];
+			char* end = nullptr;
+
+			if (strcmp(option, "--kernel") == 0) {
+				kernelName = argv[i];
+			} else if (strcmp(option, "--max-size") == 0) {
+				maxSize = strtoull(argv[i], &end, 10);
+			} else {
+				minTimeMs = strtod(argv[i], &end);
+			}
+
+			if (end && (end == argv[i] || *end != '\0')) {
+				fprintf(stderr, "Invalid '%s' value '%s'\n", option, argv[i]);
+				return 1;
+			}
+
+			continue;
+		}
+
+		fprintf(stderr, "Unknown argument '%s'. Usage: mxbench [--kernel <name>] [--max-size <n>] [--min-time <ms>] [--json]\n", argv[i]);
+		return 1;
+	}
+
+	bool kernelFound = !kernelName;
+	for (usz k = 0; k < BENCH_KERNEL_COUNT && !kernelFound; ++k) {
+		kernelFound = strcmp(BENCH_KERNELS[k].Name, kernelName) == 0;
+	}
+
+	if (!kernelFound) {
+		fprintf(stderr, "Unknown kernel '%s'\n", kernelName);
+		return 1;
+	}
+
+	if (DiagInit()) {
+		fprintf(stderr, "An unrecoverable internal error occured while initializing diagnostic support\n");
+		return 1;
+	}
+
+	// Operands are the same on every run, so results only change with the code
+	RandomInit(1);
+
+	if (json) {
+		printf("{\"version\":\"" MX_VERSION "\",\"minTimeMs\":%.1f,\"results\":[", minTimeMs);
+	} else {
+		printf("mxbench v" MX_VERSION "\n\n");
+		printf("%-12s %6s %10s %14s %14s %14s %12s %10s %10s\n", "Kernel", "Size", "Iterations", "Min ns/op", "Median ns/op", "Mean ns/op",
+			"Stddev ns", "GFLOP/s", "GB/s");
+	}
+
+	bool first = true;
+	for (usz k = 0; k < BENCH_KERNEL_COUNT; ++k) {
+		const BenchKernel* kernel = BENCH_KERNELS + k;
+		if (kernelName && strcmp(kernel->Name, kernelName) != 0) {
+			continue;
+		}
+
+		// Matrices are size x size, the parse benchmark's program is size statements long and the nested one size levels deep
+		usz lastSize = kernel->SweepMax > 0 && kernel->SweepMax < maxSize ? kernel->SweepMax : maxSize;
+		usz firstSize = kernel->SweepStep > 0 ? kernel->SweepStep : BENCH_MIN_SIZE;
+
+		for (usz size = firstSize; size <= lastSize; size = kernel->SweepStep > 0 ? size + kernel->SweepStep : size * 2) {
+			BenchCase bench = { .Size = size };
+			kernel->Setup(&bench);
+
+			BenchResult result = BenchMeasure(kernel, &bench, minTimeMs * 1e6);
+			BenchPrint(kernel, &bench, &result, json, first);
+			first = false;
+
+			BenchDeinitCase(&bench);
+		}
+	}
+
+	if (json) {
+		printf("\n]}\n");
+	}
+
+	if (DiagDeinit()) {
+		fprintf(stderr, "An unrecoverable internal error occured while deinitializing diagnostic support\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+cmake_minimum_required(VERSION 3.25)
+
+# Hashes every interpreter source file into MX_BUILD_ID. Runs on every build, but the header is only rewritten when the id
+# changes, so Cache.c is the only file recompiled for it
+file(GLOB_RECURSE BUILD_ID_FILES "${SOURCE_ROOT}/Source/*.c" "${SOURCE_ROOT}/Include/*.h")
+list(SORT BUILD_ID_FILES)
+
+set(BUILD_ID_INPUT "")
+foreach(FILE_PATH ${BUILD_ID_FILES})
+	file(RELATIVE_PATH RELATIVE_FILE_PATH "${SOURCE_ROOT}" "${FILE_PATH}")
+	file(SHA256 "${FILE_PATH}" FILE_HASH)
+	string(APPEND BUILD_ID_INPUT "${RELATIVE_FILE_PATH} ${FILE_HASH}\n")
+endforeach()
+
+string(SHA256 BUILD_ID "${BUILD_ID_INPUT}")
+file(CONFIGURE OUTPUT "${OUTPUT}" CONTENT "#pragma once\n\n#define MX_BUILD_ID \"@BUILD_ID@\"\n" @ONLY)
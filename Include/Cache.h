@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Types.h"
+
+// A checked program serialized next to nothing but its source hash. The node, shape, child and number arrays are stored as is, so a
+// cache hit maps the file and hands those sections straight to the interpreter
+typedef struct Cache {
+	void* Mapping;
+	usz MappingLength;
+} Cache;
+
+// Returns whether the program for the current source was loaded from `directory`, in which case the tokenizer, parser and
+// type checker must not be run or deinitialized
+bool CacheLoad(const char* directory);
+// Stores the parsed and checked program, failures only mean the next run starts cold
+void CacheStore(const char* directory);
+void CacheDeinit();
+
+extern Cache g_cache;
@@ -21,6 +21,7 @@ typedef enum DiagType {
 	DiagMxLiteralShapesDifferAddSub,
 	DiagMxLiteralShapesDifferMul,
 	DiagMxLiteralShapesDifferDiv,
+	DiagMxLiteralShapesDifferElementwise,
 	DiagMxLiteralShapesDifferComp,
 	DiagMxLiteralShapesDifferAssign,
 	DiagMxLiteralInvalidPower,
@@ -30,12 +31,16 @@ typedef enum DiagType {
 	DiagAssignToConstVar,
 	DiagIndexOutOfRange,
 	DiagIndexNotInteger,
+	DiagInvalidSlice,
+	DiagSliceBoundMustBeCompTime,
 	DiagTooManyFunctionCallArgs,
 	DiagTooLittleFunctionCallArgs,
 	DiagFnCallArgMustBeCompTime,
 	DiagFnCallArgMustBeVec,
+	DiagFnCallArgMustBeVar,
 	DiagFnCallArgMustBeSquare,
 	DiagFnCallArgsMustBeEqualShape,
+	DiagInvalidReductionDim,
 	DiagNotInteger,
 	DiagUndeclaredFunction,
 	DiagLogInvalidBase,
@@ -59,6 +64,7 @@ typedef enum DiagArgType {
 	DiagArgSymbolView,
 	DiagArgMxShape,
 	DiagArgNumber,
+	DiagArgSize,
 	DiagArgResult
 } DiagArgType;
 
@@ -71,6 +77,7 @@ typedef struct DiagArg {
 		SymbolView SymbolView;
 		MxShape MxShape;
 		f64 Number;
+		usz Size;
 		Result Result;
 	};
 } DiagArg;
@@ -84,6 +91,8 @@ typedef struct Diag {
 typedef struct DiagState {
 	StatArena Arena;
 	StatArenaMark Mark;
+	// Every diagnostic printed so far, notes and warnings included
+	usz ReportedCount;
 } DiagState;
 
 Result DiagInit();
@@ -108,6 +117,7 @@ extern DiagState g_diagState;
 #define DIAG_ARG_SYMBOL_VIEW(x) ((DiagArg) { DiagArgSymbolView, { .SymbolView = (x) } })
 #define DIAG_ARG_MX_SHAPE(x) ((DiagArg) { DiagArgMxShape, { .MxShape = (x) } })
 #define DIAG_ARG_NUMBER(x) ((DiagArg) { DiagArgNumber, { .Number = (x) } })
+#define DIAG_ARG_SIZE(x) ((DiagArg) { DiagArgSize, { .Size = (x) } })
 #define DIAG_ARG_RESULT(x) ((DiagArg) { DiagArgResult, { .Result = (x) } })
 
 #define DIAG_EMIT0(type, loc) DiagEmit((type), (loc), nullptr, 0)
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Types.h"
+
+// What a line costs every time it runs, statements inside loops are counted once per iteration
+typedef struct EstimateLine {
+	// Matrix bytes the line's expressions evaluate to, including the scratch space some of them need
+	usz Bytes;
+	usz Flops;
+	// Loops the line is nested in, 0 for lines that run once
+	usz LoopDepth;
+	bool HasStatement;
+} EstimateLine;
+
+// Shapes are all known after type checking, so the cost of every line follows from them without running anything
+typedef struct Estimate {
+	// Indexed by line number - 1
+	EstimateLine* Lines;
+	usz LineCount;
+} Estimate;
+
+void EstimateCompute();
+// Prints the cost of every line holding a statement, followed by the memory the planner laid the matrices out in
+void EstimatePrint();
+void EstimateDeinit();
+
+extern Estimate g_estimate;
@@ -17,6 +17,7 @@ Mx* FuncInterpretCos(ASTNode* functionCall);
 Mx* FuncInterpretTan(ASTNode* functionCall);
 Mx* FuncInterpretCot(ASTNode* functionCall);
 Mx* FuncInterpretRand(ASTNode* functionCall);
+Mx* FuncInterpretRandn(ASTNode* functionCall);
 Mx* FuncInterpretInput(ASTNode* functionCall);
 Mx* FuncInterpretReshape(ASTNode* functionCall);
 Mx* FuncInterpretDiag(ASTNode* functionCall);
@@ -24,3 +25,21 @@ Mx* FuncInterpretPow(ASTNode* functionCall);
 Mx* FuncInterpretDet(ASTNode* functionCall);
 Mx* FuncInterpretRank(ASTNode* functionCall);
 Mx* FuncInterpretInv(ASTNode* functionCall);
+Mx* FuncInterpretSum(ASTNode* functionCall);
+Mx* FuncInterpretMean(ASTNode* functionCall);
+Mx* FuncInterpretMin(ASTNode* functionCall);
+Mx* FuncInterpretMax(ASTNode* functionCall);
+Mx* FuncInterpretNorm(ASTNode* functionCall);
+Mx* FuncInterpretDot(ASTNode* functionCall);
+Mx* FuncInterpretAny(ASTNode* functionCall);
+Mx* FuncInterpretAll(ASTNode* functionCall);
+Mx* FuncInterpretWhere(ASTNode* functionCall);
+Mx* FuncInterpretSetWhere(ASTNode* functionCall);
+
+// Whether each element of the result only depends on the argument elements at the same position, so that the result can be
+// written over an argument of its shape
+bool FuncIsElementwise(ASTNode* functionCall);
+// Rough number of arithmetic operations a call performs, 0 for the ones that only move or generate values
+usz FuncFlops(ASTNode* functionCall);
+// Shape of the temporary a call works in besides its result, NO_SHAPE when it needs none
+MxShape FuncScratchShape(ASTNode* functionCall);
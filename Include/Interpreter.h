@@ -1,18 +1,29 @@
 #pragma once
 
-#include "Memory/DynArena.h"
 #include "Mx.h"
 #include "Parser.h"
 
 typedef struct Interpreter {
-	DynArena MxArena;
+	// Holds every matrix, laid out by the planner
+	u8* Slab;
+	void* SlabMemory;
+	// Length of the mapping the slab lives in, 0 when it was allocated from the heap
+	usz SlabMappingBytes;
 	Mx** VarTable;
+	// How many times every kind of node got evaluated, statements inside loops once per iteration
+	usz EvalCounts[AST_NODE_TYPE_COUNT];
 } Interpreter;
 
 [[noreturn]] void InterpreterPanic();
-Mx* InterpreterAllocMx(usz height, usz width);
+// The matrix `node` evaluates to, at the place the planner gave it
+Mx* InterpreterAllocMx(ASTNode* node, usz height, usz width);
+// The temporary `node` works in while evaluating, it must not outlive the evaluation
+Mx* InterpreterAllocScratchMx(ASTNode* node, usz height, usz width);
 Mx* InterpreterEval(ASTNode* node);
 
-void InterpreterInit();
+// With `hugePages` the slab gets mapped and backed by huge pages where the system has them
+void InterpreterInit(bool hugePages);
 void InterpreterInterpret();
 void InterpreterDeinit();
+
+extern Interpreter g_interpreter;
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Memory/MemStats.h"
+#include "Types.h"
+#include <signal.h>
+
+static constexpr usz MEM_REPORT_MAX_ENTRIES = 32;
+
+typedef struct MemReportEntry {
+	const char* Name;
+	MemStats Stats;
+} MemReportEntry;
+
+// Set when a report was asked for from outside the process, the interpreter prints it between loop iterations
+extern volatile sig_atomic_t g_memReportPending;
+
+// Fills `entries` with what every part of the interpreter holds on to, returning how many there are
+usz MemReportCollect(MemReportEntry entries[MEM_REPORT_MAX_ENTRIES]);
+// Prints the collected entries, followed by the matrix each variable currently takes up
+void MemReportPrint();
+// Makes SIGUSR1 ask for a report, on systems that have it
+void MemReportInstall();
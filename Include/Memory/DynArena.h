@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Memory/MemStats.h"
 #include "Types.h"
 #include "Result.h"
 
@@ -20,6 +21,9 @@ typedef struct DynArenaMark {
 
 typedef struct DynArena {
 	DynArenaBlock* Blocks;
+	// The only block with free memory, everything before it is full
+	DynArenaBlock* Tail;
+	MemStats Stats;
 } DynArena;
 
 Result DynArenaInit(DynArena* arena);
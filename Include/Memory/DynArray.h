@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Memory/MemStats.h"
+#include "Types.h"
+#include "Result.h"
+
+typedef struct DynArray {
+	u8* Items;
+	usz Count;
+	usz Capacity;
+	usz ItemSizeBytes;
+} DynArray;
+
+Result DynArrayInit(DynArray* array, usz itemSizeBytes);
+Result DynArrayPush(DynArray* array, const void* item);
+void* DynArrayAt(DynArray* array, usz index);
+Result DynArrayTruncate(DynArray* array, usz count);
+Result DynArrayDeinit(DynArray* array);
+
+// Arrays never shrink, so what they reserve is also the most they ever held on to
+static inline MemStats DynArrayStats(const DynArray* array)
+{
+	usz requested = array->Count * array->ItemSizeBytes;
+	usz reserved = array->Capacity * array->ItemSizeBytes;
+
+	return (MemStats) { requested, reserved, array->Items ? 1 : 0, requested, reserved };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Types.h"
+
+// What a container has handed out and what it holds on to. Peaks survive marks being undone, so they show how much a container
+// needed at its worst
+typedef struct MemStats {
+	usz RequestedBytes;
+	usz ReservedBytes;
+	usz BlockCount;
+	usz PeakRequestedBytes;
+	usz PeakReservedBytes;
+} MemStats;
+
+static inline void MemStatsRequest(MemStats* stats, usz bytes)
+{
+	stats->RequestedBytes += bytes;
+	if (stats->RequestedBytes > stats->PeakRequestedBytes) {
+		stats->PeakRequestedBytes = stats->RequestedBytes;
+	}
+}
+
+static inline void MemStatsReserve(MemStats* stats, usz bytes)
+{
+	stats->ReservedBytes += bytes;
+	++stats->BlockCount;
+	if (stats->ReservedBytes > stats->PeakReservedBytes) {
+		stats->PeakReservedBytes = stats->ReservedBytes;
+	}
+}
+
+static inline void MemStatsRelease(MemStats* stats, usz bytes)
+{
+	stats->ReservedBytes -= bytes;
+	--stats->BlockCount;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Memory/MemStats.h"
 #include "Types.h"
 #include "Result.h"
 
@@ -25,6 +26,7 @@ typedef struct StatArenaMark {
 typedef struct StatArena {
 	StatArenaBlock* Blocks;
 	usz ItemSizeBytes;
+	MemStats Stats;
 } StatArena;
 
 Result StatArenaInit(StatArena* arena, usz itemSizeBytes);
@@ -11,17 +11,32 @@ typedef struct SymbolView {
 typedef struct SymbolTableEntry {
 	u64 Hash;
 	usz KeyLength;
+	// Index + 1 of the innermost binding of this symbol while binding, 0 when it is not in scope
+	usz Binding;
 	char Key[];
 } SymbolTableEntry;
 
+// Open addressing with one control byte per slot, probed a group of 16 slots at a time
+// An empty slot has its control byte set to 0x80, a full one holds the low 7 bits of its entry's hash
 typedef struct SymbolTable {
+	u8* Controls;
 	SymbolTableEntry** Entries;
 	usz Capacity;
 	usz EntryCount;
 	DynArena Arena;
 } SymbolTable;
 
+// Interned symbols point into their entry, so it can be recovered without a lookup
+static inline SymbolTableEntry* SymbolTableEntryOf(const char* internedSymbol)
+{
+	return (SymbolTableEntry*)(void*)(internedSymbol - offsetof(SymbolTableEntry, Key));
+}
+
+u64 SymbolHash(const char* key, usz keyLength);
+
 Result SymbolTableInit(SymbolTable* table);
-Result SymbolTableContains(SymbolTable* table, const char* key, usz keyLength);
-Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, SymbolView* internedSymbol);
+Result SymbolTableContains(SymbolTable* table, const char* key, usz keyLength, u64 hash);
+Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, u64 hash, SymbolView* internedSymbol);
 Result SymbolTableDeinit(SymbolTable* table);
+// The slots together with the arena holding the entries
+MemStats SymbolTableStats(const SymbolTable* table);
@@ -4,19 +4,76 @@
 #include "Types.h"
 #include "Result.h"
 
+// Payloads of more than half a cache line start on a line of their own, smaller ones share the line of their header
+static constexpr usz MX_ALIGNMENT = 64;
+// Rows at least this wide get padded to whole cache lines, so that each of them starts on a line of its own
+static constexpr usz MX_PADDED_MIN_WIDTH = 64;
+
+// Row-major, rows are `Stride` elements apart and whatever lies between the end of a row and the start of the next one is
+// padding that is never read
 typedef struct Mx {
 	MxShape Shape;
-	f64 Data[];
+	usz Stride;
+	f64* Data;
 } Mx;
 
+static inline usz MxStrideOf(usz width) { return width >= MX_PADDED_MIN_WIDTH ? AlignUp(width, MX_ALIGNMENT / sizeof(f64)) : width; }
+
+// Bytes between the start of a matrix header and its payload
+static inline usz MxPayloadOffset(MxShape shape)
+{
+	usz payloadBytes = shape.Height * MxStrideOf(shape.Width) * sizeof(f64);
+	return payloadBytes + sizeof(Mx) <= MX_ALIGNMENT ? sizeof(Mx) : AlignUp(sizeof(Mx), MX_ALIGNMENT);
+}
+
+// Bytes a matrix of `shape` takes up, header included
+static inline usz MxBytes(MxShape shape) { return MxPayloadOffset(shape) + (shape.Height * MxStrideOf(shape.Width) * sizeof(f64)); }
+
+// Sets up the header of a matrix placed at `memory`, which has to be MX_ALIGNMENT aligned and at least MxBytes(shape) long
+static inline Mx* MxPlace(void* memory, MxShape shape)
+{
+	Mx* mx = (Mx*)memory;
+	mx->Shape = shape;
+	mx->Stride = MxStrideOf(shape.Width);
+	mx->Data = (f64*)(void*)((u8*)memory + MxPayloadOffset(shape));
+
+	return mx;
+}
+
+static inline bool MxIsContiguous(const Mx* mx) { return mx->Stride == mx->Shape.Width; }
+
+// The element at position `i` when the matrix is read row by row
+static inline f64 MxFlatAt(const Mx* mx, usz i) { return mx->Data[((i / mx->Shape.Width) * mx->Stride) + (i % mx->Shape.Width)]; }
+
+// A strided window into the data of a matrix, rows are `Stride` elements apart
+typedef struct MxView {
+	MxShape Shape;
+	usz Stride;
+	f64* Data;
+} MxView;
+
 bool IsF64Int(f64 num);
 
+MxView MxViewOf(Mx* mx, usz row, usz col, MxShape shape);
+void MxViewCopy(const MxView* src, const MxView* dst);
+
+// Both have the same shape
+void MxCopy(const Mx* src, Mx* dst);
 void MxPrint(const Mx* mx);
+bool MxBroadcastShape(const MxShape* left, const MxShape* right, MxShape* out);
 void MxAdd(const Mx* left, const Mx* right, Mx* out);
 void MxSubtract(const Mx* left, const Mx* right, Mx* out);
 void MxMultiply(const Mx* left, const Mx* right, Mx* out);
 Result MxDivide(const Mx* left, const Mx* right, Mx* out);
-Result MxToPower(const Mx* left, const Mx* right, Mx* out);
+void MxElementMultiply(const Mx* left, const Mx* right, Mx* out);
+Result MxElementDivide(const Mx* left, const Mx* right, Mx* out);
+// `temp` has the shape of `out` and is only written to
+Result MxToPower(const Mx* left, const Mx* right, Mx* out, Mx* temp);
+// Eliminates on `temp`, which has the shape of `mx`
+f64 MxDeterminant(const Mx* mx, Mx* temp);
+// Gauss-Jordan elimination on `mx` with the identity appended to it in `temp`, which is twice as wide. Fails for singular
+// matrices
+Result MxInverse(const Mx* mx, Mx* out, Mx* temp);
 void MxTranspose(const Mx* mx, Mx* out);
 void MxNegate(const Mx* mx, Mx* out);
 void MxGreater(const Mx* left, const Mx* right, Mx* out);
@@ -25,6 +82,13 @@ void MxLess(const Mx* left, const Mx* right, Mx* out);
 void MxLessEqual(const Mx* left, const Mx* right, Mx* out);
 void MxEqualEqual(const Mx* left, const Mx* right, Mx* out);
 void MxNotEqual(const Mx* left, const Mx* right, Mx* out);
+void MxElementGreater(const Mx* left, const Mx* right, Mx* out);
+void MxElementGreaterEqual(const Mx* left, const Mx* right, Mx* out);
+void MxElementLess(const Mx* left, const Mx* right, Mx* out);
+void MxElementLessEqual(const Mx* left, const Mx* right, Mx* out);
+void MxElementEqualEqual(const Mx* left, const Mx* right, Mx* out);
+void MxElementNotEqual(const Mx* left, const Mx* right, Mx* out);
+void MxSelect(const Mx* mask, const Mx* onTrue, const Mx* onFalse, Mx* out);
 bool MxTruthy(const Mx* mx);
 void MxLogicalOr(const Mx* left, const Mx* right, Mx* out);
 void MxLogicalAnd(const Mx* left, const Mx* right, Mx* out);
@@ -6,3 +6,8 @@ typedef struct MxShape {
 	usz Height;
 	usz Width;
 } MxShape;
+
+// What statements and failed checks evaluate to, real shapes are never empty
+static constexpr MxShape NO_SHAPE = { 0, 0 };
+
+static inline bool HasValue(MxShape shape) { return shape.Height != 0; }
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "MxShape.h"
-#include "Memory/DynArena.h"
-#include "Memory/StatArena.h"
+#include "Memory/DynArray.h"
 #include "Memory/SymbolTable.h"
 #include "Tokenizer.h"
 #include "Types.h"
 
-typedef enum ASTNodeType {
+// Nodes refer to each other by their index in the parser's node array
+typedef u32 ASTNodeID;
+
+// ID 0 is never handed out and stands for a missing node
+static constexpr ASTNodeID AST_NODE_NONE = 0;
+
+typedef enum ASTNodeType : u8 {
 	ASTNodeMxLiteral,
 	ASTNodeBlock,
 	ASTNodeUnary,
@@ -17,93 +22,117 @@ typedef enum ASTNodeType {
 	ASTNodeWhileStmt,
 	ASTNodeIfStmt,
 	ASTNodeIndexSuffix,
+	ASTNodeRange,
 	ASTNodeAssignment,
 	ASTNodeIdentifier,
 	ASTNodeNumber,
 	ASTNodeFunctionCall
 } ASTNodeType;
 
+static constexpr usz AST_NODE_TYPE_COUNT = ASTNodeFunctionCall + 1;
+
+// Lists of children (block statements, literal elements, call arguments) are stored contiguously in the parser's
+// child array, nodes only keep the index of the first one
 typedef struct ASTNode {
 	ASTNodeType Type;
 	SourceLoc Loc;
 
 	union {
-		f64 Number;
+		// Literals made only of numbers keep their values row-major in the parser's number array
+		struct {
+			u32 FirstValue;
+			MxShape Shape;
+		} Number;
 
 		struct {
-			struct ASTNode** Matrix;
+			u32 FirstElement;
 			MxShape Shape;
 		} MxLiteral;
 
 		struct {
-			struct ASTNode** Nodes;
-			usz NodeCount;
+			u32 FirstNode;
+			u32 NodeCount;
 		} Block;
 
 		struct {
 			TokenType Operator;
-			struct ASTNode* Operand;
+			ASTNodeID Operand;
 		} Unary;
 
 		struct {
-			struct ASTNode* Expression;
+			ASTNodeID Expression;
 		} Grouping;
 
 		struct {
-			struct ASTNode* Left;
+			ASTNodeID Left;
 			TokenType Operator;
-			struct ASTNode* Right;
+			ASTNodeID Right;
 		} Binary;
 
 		struct {
 			SymbolView Identifier;
 			MxShape Shape;
-			struct ASTNode* Expression;
+			ASTNodeID Expression;
 			bool IsConst;
 			bool HasDeclaredShape;
-			usz ID;
+			u32 ID;
 		} VarDecl;
 
 		struct {
-			struct ASTNode* Condition;
-			struct ASTNode* Body;
+			ASTNodeID Condition;
+			ASTNodeID Body;
 		} WhileStmt;
 
 		struct {
-			struct ASTNode* Condition;
-			struct ASTNode* ThenBlock;
-			struct ASTNode* ElseBlock;
+			ASTNodeID Condition;
+			ASTNodeID ThenBlock;
+			ASTNodeID ElseBlock;
 		} IfStmt;
 
 		struct {
-			struct ASTNode* I;
-			struct ASTNode* J;
+			ASTNodeID I;
+			ASTNodeID J;
 		} IndexSuffix;
 
+		// Both being AST_NODE_NONE means the whole dimension
+		struct {
+			ASTNodeID Start;
+			ASTNodeID End;
+		} Range;
+
 		struct {
 			SymbolView Identifier;
-			struct ASTNode* Index;
-			struct ASTNode* Expression;
-			usz ID;
+			ASTNodeID Index;
+			ASTNodeID Expression;
+			u32 ID;
 		} Assignment;
 
 		struct {
 			SymbolView Identifier;
-			struct ASTNode* Index;
-			usz ID;
+			ASTNodeID Index;
+			u32 ID;
 		} Identifier;
 
 		struct {
 			SymbolView Identifier;
-			struct ASTNode** CallArgs;
-			usz ArgCount;
+			u32 FirstArg;
+			u32 ArgCount;
 		} FnCall;
 	};
 } ASTNode;
 
 typedef struct Parser {
-	StatArena ASTArena;
-	DynArena ArraysArena;
+	// ASTNode, indexed by ASTNodeID
+	DynArray Nodes;
+	// ASTNodeID
+	DynArray Children;
+	// f64
+	DynArray Numbers;
+	ASTNodeID Root;
+	// Children get collected here until their count is known, nested constructs push on top of their parents
+	DynArray NodeScratch;
+	// Row widths of the matrix literals currently being parsed
+	DynArray WidthScratch;
 } Parser;
 
 void ParserInit();
@@ -112,3 +141,16 @@ void ParserPrintAST(const ASTNode* node, usz indents);
 void ParserDeinit();
 
 extern Parser g_parser;
+
+// Node pointers stay valid only until the next node is created, which is never the case after parsing
+static inline ASTNode* ASTNodeGet(ASTNodeID id) { return id ? (ASTNode*)(void*)g_parser.Nodes.Items + id : nullptr; }
+
+static inline ASTNodeID ASTNodeIDOf(const ASTNode* node) { return (ASTNodeID)(node - (const ASTNode*)(const void*)g_parser.Nodes.Items); }
+
+static inline f64* ASTNodeValues(const ASTNode* node) { return (f64*)(void*)g_parser.Numbers.Items + node->Number.FirstValue; }
+
+// The `index`-th node of the child list starting at `first`
+static inline ASTNode* ASTNodeChild(u32 first, usz index)
+{
+	return ASTNodeGet(((ASTNodeID*)(void*)g_parser.Children.Items)[first + index]);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Memory/DynArray.h"
+#include "Mx.h"
+#include "Parser.h"
+#include "Types.h"
+
+// Every matrix starts at a multiple of this within the slab
+static constexpr usz PLANNER_ALIGNMENT = MX_ALIGNMENT;
+
+typedef struct PlannerRange {
+	usz Offset;
+	usz Size;
+} PlannerRange;
+
+// Shapes are all known after type checking and nothing recurses, so where every matrix lives can be decided before running.
+// The planner walks the program in evaluation order, handing out and taking back ranges of one slab like an allocator would
+typedef struct Planner {
+	// Indexed by ASTNodeID, the offset of the matrix a node evaluates to or the variable it declares. Scratch space a node
+	// needs while it evaluates follows its matrix
+	usz* Offsets;
+	// Indexed by ASTNodeID, whether a node's matrix was written over one of its operands instead of getting a range of its own
+	bool* InPlace;
+	// PlannerRange, sorted by offset
+	DynArray FreeRanges;
+	// PlannerRange, values still needed by an enclosing node, the variables of open blocks and the arguments of calls
+	DynArray LiveRanges;
+	// End of the highest range handed out so far, the size the slab needs to be
+	usz SlabBytes;
+} Planner;
+
+void PlannerPlan();
+void PlannerDeinit();
+
+extern Planner g_planner;
+
+static inline usz PlannerMxBytes(MxShape shape) { return AlignUp(MxBytes(shape), PLANNER_ALIGNMENT); }
+
+static inline bool PlannerIsInPlace(const ASTNode* node) { return g_planner.InPlace[ASTNodeIDOf(node)]; }
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Parser.h"
+#include "Types.h"
+
+// What a line cost over the whole run. Time spent evaluating nodes of other lines is charged to those lines
+typedef struct ProfileLine {
+	u64 SelfNs;
+	// The part of `SelfNs` spent inside operators and builtins rather than walking the tree
+	u64 KernelNs;
+	usz Evaluations;
+	// Matrices the line's nodes placed in slab ranges of their own, not counting results written over an operand
+	usz MxCount;
+	usz MxBytes;
+	// Line that was running when this one was first reached, 0 for the top level. Mx has no user functions, so this is
+	// the same for every later evaluation barring several statements on one line
+	usz Parent;
+	bool Reached;
+} ProfileLine;
+
+typedef struct ProfileFrame {
+	u64 StartNs;
+	u64 OuterChildNs;
+	usz OuterLine;
+} ProfileFrame;
+
+typedef struct Profile {
+	bool Enabled;
+	// Line number of every node, resolved once up front
+	u32* NodeLines;
+	// Indexed by line number - 1
+	ProfileLine* Lines;
+	usz LineCount;
+	usz CurrentLine;
+	// Time spent in the nodes evaluated by the one currently being evaluated
+	u64 ChildNs;
+} Profile;
+
+void ProfileInit();
+ProfileFrame ProfileEnter(ASTNode* node);
+void ProfileLeave(ASTNode* node, ProfileFrame frame);
+void ProfileMx(ASTNode* node, usz bytes);
+// Prints every source line next to what it cost to stderr
+void ProfilePrint();
+// Writes one `file:line;file:line nanoseconds` entry per line that took any time, the format flame graph tools read
+bool ProfileWriteFolded(const char* path);
+void ProfileDeinit();
+
+extern Profile g_profile;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Types.h"
+
+// A counter-based generator (Philox4x32-10). Every value is a pure function of the seed and its counter, so a bulk fill can be
+// split up in any way and still produce identical results
+typedef struct Random {
+	u64 Seed;
+	// The next unused counter, every fill reserves its own range of counters
+	u64 Counter;
+} Random;
+
+void RandomInit(u64 seed);
+void RandomFillUniform(f64* out, usz count);
+void RandomFillNormal(f64* out, usz count);
+
+extern Random g_random;
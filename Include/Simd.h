@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Types.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MX_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Undefined for 0
+static inline u32 CountTrailingZeros(u32 value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (u32)index;
+#else
+	return (u32)__builtin_ctz(value);
+#endif
+}
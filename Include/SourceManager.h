@@ -2,15 +2,23 @@
 
 #include "Types.h"
 
+// Byte offset into the source, turned into a line and column only when a diagnostic gets printed
+typedef struct SourceLoc {
+	u32 Offset;
+} SourceLoc;
+
 typedef struct Source {
 	const char* FileName;
 	const char* Source;
 	usz SourceLength;
+	// Built on demand by SourceBuildLineIndex
 	const char** Lines;
 	usz LineCount;
 } Source;
 
 void SourceInit(const char* name);
+void SourceBuildLineIndex();
+void SourceResolveLoc(SourceLoc loc, usz* line, usz* linePos);
 void SourceDeinit();
 
 extern Source g_source;
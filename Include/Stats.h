@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Types.h"
+
+typedef enum StatsPhase : u8 {
+	StatsPhaseSource,
+	StatsPhaseCache,
+	StatsPhaseTokenize,
+	StatsPhaseParse,
+	StatsPhaseBind,
+	StatsPhaseTypeCheck,
+	StatsPhasePlan,
+	StatsPhaseEstimate,
+	StatsPhaseInterpret
+} StatsPhase;
+
+static constexpr usz STATS_PHASE_COUNT = StatsPhaseInterpret + 1;
+
+// Phases are timed back to back, every lap is charged to the phase that just finished
+typedef struct Stats {
+	u64 LapStartNs;
+	u64 PhaseNs[STATS_PHASE_COUNT];
+} Stats;
+
+// Nanoseconds from a monotonic clock, only differences between two readings mean anything
+u64 StatsNow();
+void StatsStart();
+void StatsLap(StatsPhase phase);
+// Prints the phase timings, what the front end produced, memory usage and how often the interpreter evaluated every kind of
+// node to stderr, as a single JSON object with `json`
+void StatsPrint(bool json);
+
+extern Stats g_stats;
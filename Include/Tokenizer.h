@@ -2,6 +2,7 @@
 
 #include "Memory/SymbolTable.h"
 #include "MxShape.h"
+#include "SourceManager.h"
 #include "Types.h"
 
 typedef enum TokenType : u16 {
@@ -18,6 +19,8 @@ typedef enum TokenType : u16 {
 	TokenSubtract,
 	TokenMultiply,
 	TokenDivide,
+	TokenElementMultiply,
+	TokenElementDivide,
 	TokenToPower,
 	TokenTranspose,
 	TokenColon,
@@ -38,14 +41,15 @@ typedef enum TokenType : u16 {
 	TokenLessEqual,
 	TokenGreater,
 	TokenGreaterEqual,
+	TokenElementEqualEqual,
+	TokenElementNotEqual,
+	TokenElementLess,
+	TokenElementLessEqual,
+	TokenElementGreater,
+	TokenElementGreaterEqual,
 	TokenEof
 } TokenType;
 
-typedef struct SourceLoc {
-	usz Line;
-	usz LinePos;
-} SourceLoc;
-
 typedef struct Token {
 	TokenType Type;
 	union {
@@ -56,15 +60,29 @@ typedef struct Token {
 	SourceLoc Loc;
 } Token;
 
+typedef union TokenValue {
+	SymbolView Lexeme;
+	f64 Number;
+	MxShape MatrixShape;
+} TokenValue;
+
+// The whole source is tokenized up front, token types are kept apart so peeking and matching stays within a few cache lines
+typedef struct TokenBuffer {
+	TokenType* Types;
+	TokenValue* Values;
+	SourceLoc* Locs;
+	usz Count;
+	usz Capacity;
+} TokenBuffer;
+
 typedef struct Tokenizer {
 	const char* SourceEnd;
 	const char* LexemeStart;
 	const char* LexemeCurrent;
-	usz SourceLine;
-	usz SourceLinePos;
 	SymbolTable TableIdentifiers;
-	Token LookaheadToken;
-	bool HasLookahead;
+	TokenBuffer Tokens;
+	usz Cursor;
+	Token CurrentToken;
 } Tokenizer;
 
 void TokenizerInit();
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "MxShape.h"
-#include "Memory/DynArena.h"
-#include "Memory/StatArena.h"
+#include "Memory/DynArray.h"
+#include "Parser.h"
 
 typedef struct TypeCheckingEntry {
 	MxShape Shape;
@@ -12,19 +12,20 @@ typedef struct TypeCheckingEntry {
 typedef struct BindingEntry {
 	const char* InternedName;
 	usz ID;
+	// Index + 1 of the binding of the same name this one shadows, 0 if there is none
+	usz Shadowed;
 } BindingEntry;
 
-typedef struct BindingScope {
-	struct BindingScope* Parent;
-	usz EntryCount;
-	BindingEntry Entries[];
-} BindingScope;
-
 typedef struct TypeChecker {
-	DynArena BindingArena;
-	BindingScope* CurBindingScope;
+	// Every binding currently in scope, innermost last
+	DynArray Bindings;
+	// Length of `Bindings` when each open scope was entered
+	DynArray BindingScopes;
+	// Deepest the binding stack got, every variable ID is below it
+	usz VarSlotCount;
 	TypeCheckingEntry* TypeCheckingTable;
-	StatArena ShapeArena;
+	// Indexed by ASTNodeID, the shape each expression evaluates to and 0x0 for everything else
+	MxShape* NodeShapes;
 } TypeChecker;
 
 void TypeCheckerInit();
@@ -33,3 +34,5 @@ void TypeCheckerTypeCheck();
 void TypeCheckerDeinit();
 
 extern TypeChecker g_typeChecker;
+
+static inline MxShape TypeCheckerShapeOf(const ASTNode* node) { return g_typeChecker.NodeShapes[ASTNodeIDOf(node)]; }
@@ -0,0 +1,418 @@
+#include "Cache.h"
+
+#include "BuildId.h"
+#include "Diagnostics.h"
+#include "Memory/SymbolTable.h"
+#include "Parser.h"
+#include "SourceManager.h"
+#include "TypeChecker.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Cache g_cache = { 0 };
+
+#ifndef _WIN32
+// Bumped whenever the layout of anything stored changes
+static constexpr u32 CACHE_FORMAT_VERSION = 3;
+static constexpr usz CACHE_SECTION_ALIGNMENT = 16;
+static constexpr usz CACHE_PATH_MAX = 4096;
+static constexpr usz CACHE_WRITE_BATCH = 256;
+
+// Followed by the node, shape, child, number and symbol sections, each starting at an aligned offset
+typedef struct CacheHeader {
+	char Magic[4];
+	u32 FormatVersion;
+	u64 InterpreterHash;
+	u64 SourceHash;
+	u64 PayloadHash;
+	u64 SourceLength;
+	u64 NodeCount;
+	u64 ChildCount;
+	u64 NumberCount;
+	u64 SymbolBytes;
+	u64 VarSlotCount;
+	u64 Root;
+} CacheHeader;
+
+typedef struct CacheLayout {
+	usz Nodes;
+	usz Shapes;
+	usz Children;
+	usz Numbers;
+	usz Symbols;
+	usz Length;
+} CacheLayout;
+
+static const char CACHE_MAGIC[4] = { 'M', 'X', 'C', '\0' };
+
+static CacheLayout CacheComputeLayout(const CacheHeader* header)
+{
+	CacheLayout layout;
+	layout.Nodes = AlignUp(sizeof(CacheHeader), CACHE_SECTION_ALIGNMENT);
+	layout.Shapes = AlignUp(layout.Nodes + (header->NodeCount * sizeof(ASTNode)), CACHE_SECTION_ALIGNMENT);
+	layout.Children = AlignUp(layout.Shapes + (header->NodeCount * sizeof(MxShape)), CACHE_SECTION_ALIGNMENT);
+	layout.Numbers = AlignUp(layout.Children + (header->ChildCount * sizeof(ASTNodeID)), CACHE_SECTION_ALIGNMENT);
+	layout.Symbols = AlignUp(layout.Numbers + (header->NumberCount * sizeof(f64)), CACHE_SECTION_ALIGNMENT);
+	layout.Length = layout.Symbols + header->SymbolBytes;
+
+	return layout;
+}
+
+// A cache is only valid for the interpreter build that wrote it, any change to the parser, type checker or planner can change
+// what its nodes and shapes mean. MX_BUILD_ID hashes every source file, the layout only guards against differing compilers
+static u64 CacheInterpreterHash()
+{
+	static const char BUILD_ID[] = MX_VERSION " " MX_BUILD_ID;
+	const u64 layout[] = { sizeof(ASTNode), sizeof(MxShape), sizeof(SourceLoc), AST_NODE_TYPE_COUNT, TokenEof };
+
+	return SymbolHash(BUILD_ID, sizeof(BUILD_ID) - 1) ^ SymbolHash((const char*)layout, sizeof(layout));
+}
+
+// Covers everything after the header, the index checks alone would still accept a child pointing at the wrong node
+static u64 CachePayloadHash(const u8* mapping, usz length)
+{
+	return SymbolHash((const char*)mapping + sizeof(CacheHeader), length - sizeof(CacheHeader));
+}
+
+static bool CachePath(const char* directory, u64 sourceHash, char* path)
+{
+	i32 length = snprintf(path, CACHE_PATH_MAX, "%s/%016llx.mxc", directory, (unsigned long long)sourceHash);
+	return length > 0 && (usz)length < CACHE_PATH_MAX;
+}
+
+// The symbols a node refers to by name. In the file their pointers hold offsets into the symbol section instead
+static SymbolView* CacheNodeSymbol(ASTNode* node)
+{
+	switch (node->Type) {
+	case ASTNodeVarDecl:
+		return &node->VarDecl.Identifier;
+	case ASTNodeAssignment:
+		return &node->Assignment.Identifier;
+	case ASTNodeIdentifier:
+		return &node->Identifier.Identifier;
+	case ASTNodeFunctionCall:
+		return &node->FnCall.Identifier;
+	default:
+		return nullptr;
+	}
+}
+
+static bool CacheInRange(u64 first, u64 count, u64 total) { return first <= total && count <= total - first; }
+
+static bool CacheValidNodeID(const CacheHeader* header, ASTNodeID id) { return id < header->NodeCount; }
+
+static bool CacheValidElements(u64 first, MxShape shape, u64 total)
+{
+	if (shape.Width > 0 && shape.Height > total / shape.Width) {
+		return false;
+	}
+
+	return CacheInRange(first, (u64)shape.Height * shape.Width, total);
+}
+
+// Every index a node holds must stay within the sections it points into, the rest of the interpreter trusts them
+static bool CacheValidNode(const CacheHeader* header, const ASTNode* node)
+{
+	if (node->Type >= AST_NODE_TYPE_COUNT || node->Loc.Offset > header->SourceLength) {
+		return false;
+	}
+
+	switch (node->Type) {
+	case ASTNodeNumber:
+		return CacheValidElements(node->Number.FirstValue, node->Number.Shape, header->NumberCount);
+	case ASTNodeMxLiteral:
+		return CacheValidElements(node->MxLiteral.FirstElement, node->MxLiteral.Shape, header->ChildCount);
+	case ASTNodeBlock:
+		return CacheInRange(node->Block.FirstNode, node->Block.NodeCount, header->ChildCount);
+	case ASTNodeUnary:
+		return CacheValidNodeID(header, node->Unary.Operand);
+	case ASTNodeGrouping:
+		return CacheValidNodeID(header, node->Grouping.Expression);
+	case ASTNodeBinary:
+		return CacheValidNodeID(header, node->Binary.Left) && CacheValidNodeID(header, node->Binary.Right);
+	case ASTNodeVarDecl:
+		return CacheValidNodeID(header, node->VarDecl.Expression) && node->VarDecl.ID < header->VarSlotCount;
+	case ASTNodeWhileStmt:
+		return CacheValidNodeID(header, node->WhileStmt.Condition) && CacheValidNodeID(header, node->WhileStmt.Body);
+	case ASTNodeIfStmt:
+		return CacheValidNodeID(header, node->IfStmt.Condition) && CacheValidNodeID(header, node->IfStmt.ThenBlock)
+			&& CacheValidNodeID(header, node->IfStmt.ElseBlock);
+	case ASTNodeIndexSuffix:
+		return CacheValidNodeID(header, node->IndexSuffix.I) && CacheValidNodeID(header, node->IndexSuffix.J);
+	case ASTNodeRange:
+		return CacheValidNodeID(header, node->Range.Start) && CacheValidNodeID(header, node->Range.End);
+	case ASTNodeAssignment:
+		return CacheValidNodeID(header, node->Assignment.Index) && CacheValidNodeID(header, node->Assignment.Expression)
+			&& node->Assignment.ID < header->VarSlotCount;
+	case ASTNodeIdentifier:
+		return CacheValidNodeID(header, node->Identifier.Index) && node->Identifier.ID < header->VarSlotCount;
+	case ASTNodeFunctionCall:
+		return CacheInRange(node->FnCall.FirstArg, node->FnCall.ArgCount, header->ChildCount);
+	}
+
+	return false;
+}
+
+// Checks the sizes before the layout gets computed from them, so a corrupted header can't wrap the offsets around
+static bool CacheValidHeader(const CacheHeader* header, usz length, u64 sourceHash)
+{
+	if (memcmp(header->Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header->FormatVersion != CACHE_FORMAT_VERSION
+		|| header->InterpreterHash != CacheInterpreterHash() || header->SourceHash != sourceHash
+		|| header->SourceLength != g_source.SourceLength) {
+		return false;
+	}
+
+	if (header->NodeCount == 0 || header->NodeCount > length / sizeof(ASTNode) || header->ChildCount > length / sizeof(ASTNodeID)
+		|| header->NumberCount > length / sizeof(f64) || header->SymbolBytes > length || header->Root >= header->NodeCount
+		|| header->VarSlotCount > header->NodeCount) {
+		return false;
+	}
+
+	return CacheComputeLayout(header).Length == length && header->PayloadHash == CachePayloadHash((const u8*)header, length);
+}
+
+// Validates every node and child, then points the symbols of the nodes into the symbol section
+static bool CacheValidateAndPatch(const CacheHeader* header, u8* mapping)
+{
+	CacheLayout layout = CacheComputeLayout(header);
+
+	const ASTNodeID* children = (const ASTNodeID*)(void*)(mapping + layout.Children);
+	for (usz i = 0; i < header->ChildCount; ++i) {
+		if (!CacheValidNodeID(header, children[i])) {
+			return false;
+		}
+	}
+
+	ASTNode* nodes = (ASTNode*)(void*)(mapping + layout.Nodes);
+	const char* symbols = (const char*)(mapping + layout.Symbols);
+	for (usz i = 0; i < header->NodeCount; ++i) {
+		if (!CacheValidNode(header, nodes + i)) {
+			return false;
+		}
+
+		SymbolView* symbol = CacheNodeSymbol(nodes + i);
+		if (!symbol) {
+			continue;
+		}
+
+		uintptr_t offset = (uintptr_t)symbol->Symbol;
+		if (!CacheInRange(offset, symbol->SymbolLength, header->SymbolBytes)) {
+			return false;
+		}
+
+		symbol->Symbol = symbols + offset;
+	}
+
+	return true;
+}
+
+static bool CacheWritePadded(FILE* file, const void* data, usz length, usz* offset, usz sectionOffset)
+{
+	static const u8 zeros[CACHE_SECTION_ALIGNMENT] = { 0 };
+	if (fwrite(zeros, 1, sectionOffset - *offset, file) != sectionOffset - *offset) {
+		return false;
+	}
+
+	*offset = sectionOffset + length;
+	return fwrite(data, 1, length, file) == length;
+}
+
+static bool CacheWrite(FILE* file, const CacheHeader* header)
+{
+	CacheLayout layout = CacheComputeLayout(header);
+
+	usz offset = 0;
+	if (!CacheWritePadded(file, header, sizeof(CacheHeader), &offset, 0)) {
+		return false;
+	}
+
+	// Nodes get their symbol pointers swapped for offsets a batch at a time, the parser's copy stays untouched
+	ASTNode batch[CACHE_WRITE_BATCH];
+	usz symbolOffset = 0;
+	for (usz i = 0; i < g_parser.Nodes.Count; i += CACHE_WRITE_BATCH) {
+		usz count = g_parser.Nodes.Count - i < CACHE_WRITE_BATCH ? g_parser.Nodes.Count - i : CACHE_WRITE_BATCH;
+		memcpy(batch, DynArrayAt(&g_parser.Nodes, i), count * sizeof(ASTNode));
+
+		for (usz j = 0; j < count; ++j) {
+			SymbolView* symbol = CacheNodeSymbol(batch + j);
+			if (symbol) {
+				symbol->Symbol = (const char*)(uintptr_t)symbolOffset;
+				symbolOffset += symbol->SymbolLength;
+			}
+		}
+
+		if (!CacheWritePadded(file, batch, count * sizeof(ASTNode), &offset, i == 0 ? layout.Nodes : offset)) {
+			return false;
+		}
+	}
+
+	if (!CacheWritePadded(file, g_typeChecker.NodeShapes, g_parser.Nodes.Count * sizeof(MxShape), &offset, layout.Shapes)
+		|| !CacheWritePadded(file, g_parser.Children.Items, g_parser.Children.Count * sizeof(ASTNodeID), &offset, layout.Children)
+		|| !CacheWritePadded(file, g_parser.Numbers.Items, g_parser.Numbers.Count * sizeof(f64), &offset, layout.Numbers)) {
+		return false;
+	}
+
+	usz sectionOffset = layout.Symbols;
+	for (usz i = 0; i < g_parser.Nodes.Count; ++i) {
+		SymbolView* symbol = CacheNodeSymbol(DynArrayAt(&g_parser.Nodes, i));
+		if (!symbol) {
+			continue;
+		}
+
+		if (!CacheWritePadded(file, symbol->Symbol, symbol->SymbolLength, &offset, sectionOffset)) {
+			return false;
+		}
+
+		sectionOffset = offset;
+	}
+
+	// Hashed from the file itself, the nodes written differ from the parser's copy
+	if (fflush(file) != 0) {
+		return false;
+	}
+
+	u8* mapping = mmap(nullptr, layout.Length, PROT_READ, MAP_SHARED, fileno(file), 0);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	u64 payloadHash = CachePayloadHash(mapping, layout.Length);
+	munmap(mapping, layout.Length);
+
+	return fseek(file, offsetof(CacheHeader, PayloadHash), SEEK_SET) == 0 && fwrite(&payloadHash, sizeof(payloadHash), 1, file) == 1;
+}
+#endif
+
+bool CacheLoad(const char* directory)
+{
+#ifdef _WIN32
+	(void)directory;
+	return false;
+#else
+	u64 sourceHash = SymbolHash(g_source.Source, g_source.SourceLength);
+
+	char path[CACHE_PATH_MAX];
+	if (!CachePath(directory, sourceHash, path)) {
+		return false;
+	}
+
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || (usz)info.st_size < sizeof(CacheHeader)) {
+		close(file);
+		return false;
+	}
+
+	// Private and writable, symbol pointers get patched in place and only the pages holding them are copied
+	usz length = (usz)info.st_size;
+	u8* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	// A truncated or corrupted file is treated like a miss
+	const CacheHeader* header = (const CacheHeader*)(void*)mapping;
+	if (!CacheValidHeader(header, length, sourceHash) || !CacheValidateAndPatch(header, mapping)) {
+		munmap(mapping, length);
+		return false;
+	}
+
+	CacheLayout layout = CacheComputeLayout(header);
+
+	g_parser.Nodes = (DynArray) { mapping + layout.Nodes, header->NodeCount, header->NodeCount, sizeof(ASTNode) };
+	g_parser.Children = (DynArray) { mapping + layout.Children, header->ChildCount, header->ChildCount, sizeof(ASTNodeID) };
+	g_parser.Numbers = (DynArray) { mapping + layout.Numbers, header->NumberCount, header->NumberCount, sizeof(f64) };
+	g_parser.Root = (ASTNodeID)header->Root;
+	g_typeChecker.VarSlotCount = header->VarSlotCount;
+	g_typeChecker.NodeShapes = (MxShape*)(void*)(mapping + layout.Shapes);
+
+	g_cache.Mapping = mapping;
+	g_cache.MappingLength = length;
+
+	return true;
+#endif
+}
+
+void CacheStore(const char* directory)
+{
+#ifdef _WIN32
+	(void)directory;
+#else
+	// A hit would not repeat them
+	if (g_diagState.ReportedCount > 0) {
+		return;
+	}
+
+	CacheHeader header = {
+		.FormatVersion = CACHE_FORMAT_VERSION,
+		.InterpreterHash = CacheInterpreterHash(),
+		.SourceHash = SymbolHash(g_source.Source, g_source.SourceLength),
+		.SourceLength = g_source.SourceLength,
+		.NodeCount = g_parser.Nodes.Count,
+		.ChildCount = g_parser.Children.Count,
+		.NumberCount = g_parser.Numbers.Count,
+		.VarSlotCount = g_typeChecker.VarSlotCount,
+		.Root = g_parser.Root,
+	};
+	memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+
+	for (usz i = 0; i < g_parser.Nodes.Count; ++i) {
+		SymbolView* symbol = CacheNodeSymbol(DynArrayAt(&g_parser.Nodes, i));
+		if (symbol) {
+			header.SymbolBytes += symbol->SymbolLength;
+		}
+	}
+
+	char path[CACHE_PATH_MAX];
+	char tempPath[CACHE_PATH_MAX];
+	if (!CachePath(directory, header.SourceHash, path)) {
+		return;
+	}
+
+	i32 tempLength = snprintf(tempPath, CACHE_PATH_MAX, "%s.%ld.tmp", path, (long)getpid());
+	if (tempLength <= 0 || (usz)tempLength >= CACHE_PATH_MAX) {
+		return;
+	}
+
+	mkdir(directory, 0755);
+
+	FILE* file = fopen(tempPath, "w+b");
+	if (!file) {
+		return;
+	}
+
+	bool written = CacheWrite(file, &header);
+	written = fclose(file) == 0 && written;
+
+	// Readers only ever see complete files
+	if (!written || rename(tempPath, path) != 0) {
+		remove(tempPath);
+	}
+#endif
+}
+
+void CacheDeinit()
+{
+#ifndef _WIN32
+	if (g_cache.Mapping) {
+		munmap(g_cache.Mapping, g_cache.MappingLength);
+	}
+#endif
+
+	g_cache.Mapping = nullptr;
+	g_cache.MappingLength = 0;
+}
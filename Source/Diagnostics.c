@@ -32,6 +32,7 @@ static const DiagInfo DIAG_TYPE_INFO[] = { [DiagExpectedToken] = { DiagLevelErro
 	[DiagMxLiteralShapesDifferMul] = { DiagLevelError, "Matrices of shapes %0 and %1 cannot be multiplied together" },
 	[DiagMxLiteralShapesDifferDiv]
 	= { DiagLevelError, "Matrices of shapes %0 and %1 cannot be divided together. Consider multiplication by the inverse matrix" },
+	[DiagMxLiteralShapesDifferElementwise] = { DiagLevelError, "Matrices of shapes %0 and %1 cannot be broadcast together" },
 	[DiagMxLiteralShapesDifferComp] = { DiagLevelError, "Matrices of shapes %0 and %1 cannot be compared together" },
 	[DiagMxLiteralShapesDifferAssign] = { DiagLevelError, "Assigning a matrix of shape %0 to a variable of shape %1" },
 	[DiagMxLiteralInvalidPower] = { DiagLevelError, "Matrix exponentiation requires a positive, natural, 1x1 exponent" },
@@ -41,12 +42,16 @@ static const DiagInfo DIAG_TYPE_INFO[] = { [DiagExpectedToken] = { DiagLevelErro
 	[DiagAssignToConstVar] = { DiagLevelError, "Assignment to a constant variable" },
 	[DiagIndexOutOfRange] = { DiagLevelError, "Index %0 out of range for matrix of shape %1" },
 	[DiagIndexNotInteger] = { DiagLevelError, "Index %0 is not an integer" },
+	[DiagInvalidSlice] = { DiagLevelError, "Slice %0:%1 is invalid for a dimension of size %2" },
+	[DiagSliceBoundMustBeCompTime] = { DiagLevelError, "Slice bounds must be compile-time 1x1 integer literals" },
 	[DiagTooManyFunctionCallArgs] = { DiagLevelError, "Too many arguments in function call %0" },
 	[DiagTooLittleFunctionCallArgs] = { DiagLevelError, "Too little arguments in function call %0" },
 	[DiagFnCallArgMustBeCompTime] = { DiagLevelError, "Function call argument here must be a compile-time 1x1 matrix literal" },
 	[DiagFnCallArgMustBeVec] = { DiagLevelError, "Function call argument here must be a vector" },
+	[DiagFnCallArgMustBeVar] = { DiagLevelError, "Function call argument here must be an unindexed variable" },
 	[DiagFnCallArgMustBeSquare] = { DiagLevelError, "Function call argument here must be square" },
 	[DiagFnCallArgsMustBeEqualShape] = { DiagLevelError, "Function call arguments here must have identical shapes" },
+	[DiagInvalidReductionDim] = { DiagLevelError, "Reduction dimension must be either 1 (column-wise) or 2 (row-wise)" },
 	[DiagNotInteger] = { DiagLevelError, "Number must be an integer" },
 	[DiagUndeclaredFunction] = { DiagLevelError, "Call to undeclared function %0" },
 	[DiagLogInvalidBase] = { DiagLevelError, "Logarithm base %0 must be greater than 0 and not equal to 1" },
@@ -149,6 +154,12 @@ static void PrintTokenType(TokenType tokenType, FILE* out)
 	case TokenDivide:
 		fputs("'/'", out);
 		break;
+	case TokenElementMultiply:
+		fputs("'.*'", out);
+		break;
+	case TokenElementDivide:
+		fputs("'./'", out);
+		break;
 	case TokenToPower:
 		fputs("'^'", out);
 		break;
@@ -209,6 +220,24 @@ static void PrintTokenType(TokenType tokenType, FILE* out)
 	case TokenGreaterEqual:
 		fputs("'>='", out);
 		break;
+	case TokenElementEqualEqual:
+		fputs("'.=='", out);
+		break;
+	case TokenElementNotEqual:
+		fputs("'.!='", out);
+		break;
+	case TokenElementLess:
+		fputs("'.<'", out);
+		break;
+	case TokenElementLessEqual:
+		fputs("'.<='", out);
+		break;
+	case TokenElementGreater:
+		fputs("'.>'", out);
+		break;
+	case TokenElementGreaterEqual:
+		fputs("'.>='", out);
+		break;
 	case TokenEof:
 		fputs("EOF", out);
 		break;
@@ -254,6 +283,9 @@ static void PrintDiagFormat(FILE* out, const char* format, const Diag* diag)
 			case DiagArgNumber:
 				fprintf(out, "'%lf'", diag->Args[i].Number);
 				break;
+			case DiagArgSize:
+				fprintf(out, "%zu", diag->Args[i].Size);
+				break;
 			case DiagArgResult:
 				PrintResult(diag->Args[i].Result, out);
 				break;
@@ -274,26 +306,31 @@ static void DiagPrint(const Diag* diag)
 
 	FILE* out = info->Level == DiagLevelError ? stderr : stdout;
 
+	usz line;
+	usz linePos;
+	SourceResolveLoc(diag->Loc, &line, &linePos);
+
 	fputs("\033[1m", out);
-	fprintf(out, "%s:%zu:%zu %s: ", g_source.FileName, diag->Loc.Line, diag->Loc.LinePos, DIAG_LEVEL_STR[info->Level]);
+	fprintf(out, "%s:%zu:%zu %s: ", g_source.FileName, line, linePos, DIAG_LEVEL_STR[info->Level]);
 	fputs("\033[0m\033[1m", out);
 	PrintDiagFormat(out, info->Format, diag);
 	fputs("\033[0m", out);
 
 	fputc('\n', out);
 
-	usz numWidth = NumberWidth(diag->Loc.Line);
+	usz numWidth = NumberWidth(line);
 
 	for (usz i = 0; i < numWidth; ++i) {
 		fputc(' ', out);
 	}
 	fprintf(out, " |\n");
 
-	fprintf(out, "%zu | ", diag->Loc.Line);
+	fprintf(out, "%zu | ", line);
 
-	const char* iter = g_source.Lines[diag->Loc.Line - 1];
+	const char* iter = g_source.Lines[line - 1];
+	const char* end = g_source.Source + g_source.SourceLength;
 	bool beginning = true;
-	while (*iter != '\n' && *iter != '\0') {
+	while (iter < end && *iter != '\n') {
 		if (beginning && isspace(*iter)) {
 			++iter;
 			continue;
@@ -311,8 +348,8 @@ static void DiagPrint(const Diag* diag)
 	fprintf(out, " | ");
 
 	beginning = true;
-	for (usz i = 0; i < diag->Loc.LinePos - 1; ++i) {
-		if (beginning && isspace(g_source.Lines[diag->Loc.Line - 1][i])) {
+	for (usz i = 0; i < linePos - 1; ++i) {
+		if (beginning && isspace(g_source.Lines[line - 1][i])) {
 			continue;
 		}
 
@@ -369,6 +406,7 @@ usz DiagReport()
 		Diag* diag = iter.Item;
 
 		DiagPrint(diag);
+		++g_diagState.ReportedCount;
 
 		const DiagInfo* info = DIAG_TYPE_INFO + diag->Type;
 		if (info->Level == DiagLevelError) {
@@ -0,0 +1,229 @@
+#include "Estimate.h"
+
+#include "Diagnostics.h"
+#include "Functions.h"
+#include "Parser.h"
+#include "Planner.h"
+#include "SourceManager.h"
+#include "TypeChecker.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+Estimate g_estimate = { 0 };
+
+static usz EstimateElements(MxShape shape) { return shape.Height * shape.Width; }
+
+static usz EstimateBinaryFlops(ASTNode* node)
+{
+	MxShape left = TypeCheckerShapeOf(ASTNodeGet(node->Binary.Left));
+	MxShape right = TypeCheckerShapeOf(ASTNodeGet(node->Binary.Right));
+	bool scalarOperand = (left.Height == 1 && left.Width == 1) || (right.Height == 1 && right.Width == 1);
+
+	switch (node->Binary.Operator) {
+	case TokenMultiply:
+		return scalarOperand ? EstimateElements(TypeCheckerShapeOf(node)) : 2 * left.Height * left.Width * right.Width;
+	case TokenToPower: {
+		if (left.Height == 1 && left.Width == 1) {
+			return 1;
+		}
+
+		// Every power past the first is one more multiplication, powers only known at runtime count as a single one
+		ASTNode* power = ASTNodeGet(node->Binary.Right);
+		usz multiplications = 1;
+		if (power->Type == ASTNodeNumber) {
+			multiplications = ASTNodeValues(power)[0] > 1 ? (usz)ASTNodeValues(power)[0] - 1 : 0;
+		}
+
+		return multiplications * 2 * left.Height * left.Height * left.Width;
+	}
+	case TokenGreater:
+	case TokenGreaterEqual:
+	case TokenLess:
+	case TokenLessEqual:
+	case TokenEqualEqual:
+	case TokenNotEqual:
+		return EstimateElements(left);
+	default:
+		return EstimateElements(TypeCheckerShapeOf(node));
+	}
+}
+
+// Adds up what evaluating an expression costs, only nodes the planner gave a range of their own add bytes
+static void EstimateExpression(ASTNode* node, EstimateLine* line)
+{
+	if (!node) {
+		return;
+	}
+
+	MxShape shape = TypeCheckerShapeOf(node);
+
+	switch (node->Type) {
+	case ASTNodeNumber:
+		line->Bytes += PlannerMxBytes(shape);
+		return;
+	case ASTNodeMxLiteral:
+		line->Bytes += PlannerMxBytes(shape);
+
+		for (usz i = 0; i < node->MxLiteral.Shape.Height * node->MxLiteral.Shape.Width; ++i) {
+			EstimateExpression(ASTNodeChild(node->MxLiteral.FirstElement, i), line);
+		}
+
+		return;
+	case ASTNodeUnary:
+		EstimateExpression(ASTNodeGet(node->Unary.Operand), line);
+
+		// Negation happens in place, transposing only moves elements
+		if (node->Unary.Operator == TokenSubtract) {
+			line->Flops += EstimateElements(shape);
+		} else {
+			line->Bytes += PlannerMxBytes(shape);
+		}
+
+		return;
+	case ASTNodeGrouping:
+		EstimateExpression(ASTNodeGet(node->Grouping.Expression), line);
+		return;
+	case ASTNodeBinary:
+		EstimateExpression(ASTNodeGet(node->Binary.Left), line);
+		EstimateExpression(ASTNodeGet(node->Binary.Right), line);
+
+		if (!PlannerIsInPlace(node)) {
+			line->Bytes += PlannerMxBytes(shape) * (node->Binary.Operator == TokenToPower ? 2 : 1);
+		}
+
+		line->Flops += EstimateBinaryFlops(node);
+		return;
+	case ASTNodeVarDecl:
+		line->Bytes += PlannerMxBytes(node->VarDecl.Shape);
+		EstimateExpression(ASTNodeGet(node->VarDecl.Expression), line);
+		return;
+	case ASTNodeIndexSuffix: {
+		ASTNode* i = ASTNodeGet(node->IndexSuffix.I);
+		if (i->Type != ASTNodeRange) {
+			EstimateExpression(i, line);
+		}
+
+		ASTNode* j = ASTNodeGet(node->IndexSuffix.J);
+		if (j && j->Type != ASTNodeRange) {
+			EstimateExpression(j, line);
+		}
+
+		return;
+	}
+	case ASTNodeAssignment:
+		EstimateExpression(ASTNodeGet(node->Assignment.Expression), line);
+		EstimateExpression(ASTNodeGet(node->Assignment.Index), line);
+		return;
+	case ASTNodeIdentifier:
+		EstimateExpression(ASTNodeGet(node->Identifier.Index), line);
+		line->Bytes += PlannerMxBytes(shape);
+		return;
+	case ASTNodeFunctionCall: {
+		for (usz i = 0; i < node->FnCall.ArgCount; ++i) {
+			EstimateExpression(ASTNodeChild(node->FnCall.FirstArg, i), line);
+		}
+
+		if (HasValue(shape) && !PlannerIsInPlace(node)) {
+			line->Bytes += PlannerMxBytes(shape);
+		}
+
+		MxShape scratch = FuncScratchShape(node);
+		if (HasValue(scratch)) {
+			line->Bytes += PlannerMxBytes(scratch);
+		}
+
+		line->Flops += FuncFlops(node);
+		return;
+	}
+	default:
+		return;
+	}
+}
+
+static EstimateLine* EstimateLineOf(ASTNode* node, usz loopDepth)
+{
+	usz lineNumber;
+	usz linePos;
+	SourceResolveLoc(node->Loc, &lineNumber, &linePos);
+
+	EstimateLine* line = g_estimate.Lines + lineNumber - 1;
+	line->HasStatement = true;
+	if (loopDepth > line->LoopDepth) {
+		line->LoopDepth = loopDepth;
+	}
+
+	return line;
+}
+
+static void EstimateStatement(ASTNode* node, usz loopDepth)
+{
+	if (!node) {
+		return;
+	}
+
+	switch (node->Type) {
+	case ASTNodeBlock:
+		for (usz i = 0; i < node->Block.NodeCount; ++i) {
+			EstimateStatement(ASTNodeChild(node->Block.FirstNode, i), loopDepth);
+		}
+
+		return;
+	case ASTNodeIfStmt:
+		EstimateExpression(ASTNodeGet(node->IfStmt.Condition), EstimateLineOf(node, loopDepth));
+		EstimateStatement(ASTNodeGet(node->IfStmt.ThenBlock), loopDepth);
+		EstimateStatement(ASTNodeGet(node->IfStmt.ElseBlock), loopDepth);
+		return;
+	case ASTNodeWhileStmt:
+		// The condition gets evaluated once per iteration too
+		EstimateExpression(ASTNodeGet(node->WhileStmt.Condition), EstimateLineOf(node, loopDepth + 1));
+		EstimateStatement(ASTNodeGet(node->WhileStmt.Body), loopDepth + 1);
+		return;
+	default:
+		EstimateExpression(node, EstimateLineOf(node, loopDepth));
+		return;
+	}
+}
+
+void EstimateCompute()
+{
+	SourceBuildLineIndex();
+	if (g_source.LineCount == 0) {
+		return;
+	}
+
+	g_estimate.LineCount = g_source.LineCount;
+	g_estimate.Lines = (EstimateLine*)calloc(g_estimate.LineCount, sizeof(EstimateLine));
+	if (!g_estimate.Lines) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	EstimateStatement(ASTNodeGet(g_parser.Root), 0);
+}
+
+void EstimatePrint()
+{
+	printf("%6s %16s %16s\n", "Line", "Bytes", "FLOPs");
+
+	for (usz i = 0; i < g_estimate.LineCount; ++i) {
+		EstimateLine* line = g_estimate.Lines + i;
+		if (!line->HasStatement) {
+			continue;
+		}
+
+		printf("%6zu %16zu %16zu", i + 1, line->Bytes, line->Flops);
+		if (line->LoopDepth > 0) {
+			printf("  per iteration");
+		}
+
+		printf("\n");
+	}
+
+	printf("\nPeak matrix memory: %zu bytes\n", g_planner.SlabBytes);
+}
+
+void EstimateDeinit()
+{
+	free((void*)g_estimate.Lines);
+	g_estimate.Lines = nullptr;
+	g_estimate.LineCount = 0;
+}
@@ -2,6 +2,8 @@
 
 #include "Diagnostics.h"
 #include "Interpreter.h"
+#include "Random.h"
+#include "TypeChecker.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,14 +13,14 @@
 Mx* FuncInterpretDisplay(ASTNode* functionCall)
 {
 	for (size_t i = 0; i < functionCall->FnCall.ArgCount; ++i) {
-		Mx* mx = InterpreterEval(functionCall->FnCall.CallArgs[i]);
+		Mx* mx = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, i));
 		if (!mx) {
 			continue;
 		}
 
-		if (functionCall->FnCall.CallArgs[i]->Type == ASTNodeIdentifier) {
-			printf("%.*s: ", (i32)functionCall->FnCall.CallArgs[i]->Identifier.Identifier.SymbolLength,
-				functionCall->FnCall.CallArgs[i]->Identifier.Identifier.Symbol);
+		if (ASTNodeChild(functionCall->FnCall.FirstArg, i)->Type == ASTNodeIdentifier) {
+			printf("%.*s: ", (i32)ASTNodeChild(functionCall->FnCall.FirstArg, i)->Identifier.Identifier.SymbolLength,
+				ASTNodeChild(functionCall->FnCall.FirstArg, i)->Identifier.Identifier.Symbol);
 		} else {
 			printf("imm: ");
 		}
@@ -37,15 +39,17 @@ Mx* FuncInterpretDisplay(ASTNode* functionCall)
 
 Mx* FuncInterpretFill(ASTNode* functionCall)
 {
-	usz height = (usz)functionCall->FnCall.CallArgs[0]->MxLiteral.Matrix[0]->Number;
-	usz width = (usz)functionCall->FnCall.CallArgs[1]->MxLiteral.Matrix[0]->Number;
+	usz height = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 0))[0];
+	usz width = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 1))[0];
 
-	Mx* fillValue = InterpreterEval(functionCall->FnCall.CallArgs[2]);
+	Mx* fillValue = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 2));
 
-	Mx* mx = InterpreterAllocMx(height, width);
+	Mx* mx = InterpreterAllocMx(functionCall, height, width);
 
-	for (usz i = 0; i < height * width; ++i) {
-		mx->Data[i] = fillValue->Data[0];
+	for (usz i = 0; i < height; ++i) {
+		for (usz j = 0; j < width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = fillValue->Data[0];
+		}
 	}
 
 	return mx;
@@ -53,13 +57,13 @@ Mx* FuncInterpretFill(ASTNode* functionCall)
 
 Mx* FuncInterpretIdent(ASTNode* functionCall)
 {
-	usz size = (usz)functionCall->FnCall.CallArgs[0]->MxLiteral.Matrix[0]->Number;
+	usz size = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 0))[0];
 
-	Mx* mx = InterpreterAllocMx(size, size);
-	memset(mx->Data, 0, size * size * sizeof(f64));
+	Mx* mx = InterpreterAllocMx(functionCall, size, size);
+	memset(mx->Data, 0, size * mx->Stride * sizeof(f64));
 
 	for (usz i = 0; i < size; ++i) {
-		mx->Data[(i * size) + i] = 1;
+		mx->Data[(i * mx->Stride) + i] = 1;
 	}
 
 	return mx;
@@ -67,26 +71,29 @@ Mx* FuncInterpretIdent(ASTNode* functionCall)
 
 Mx* FuncInterpretLog(ASTNode* functionCall)
 {
-	Mx* base = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* base = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
 	if (base->Data[0] <= 0 || base->Data[0] == 1) {
-		DIAG_EMIT(DiagLogInvalidBase, functionCall->FnCall.CallArgs[0]->Loc, DIAG_ARG_NUMBER(base->Data[0]));
+		DIAG_EMIT(DiagLogInvalidBase, ASTNodeChild(functionCall->FnCall.FirstArg, 0)->Loc, DIAG_ARG_NUMBER(base->Data[0]));
 		InterpreterPanic();
 	}
 
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[1]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 1));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
 	f64 baseLnInverse = 1 / log(base->Data[0]);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		if (arg->Data[i] <= 0) {
-			DIAG_EMIT(DiagLogInvalidArg, functionCall->FnCall.CallArgs[1]->Loc, DIAG_ARG_NUMBER(arg->Data[i]));
-			InterpreterPanic();
-		}
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			if (arg->Data[(i * arg->Stride) + j] <= 0) {
+				DIAG_EMIT(DiagLogInvalidArg, ASTNodeChild(functionCall->FnCall.FirstArg, 1)->Loc,
+					DIAG_ARG_NUMBER(arg->Data[(i * arg->Stride) + j]));
+				InterpreterPanic();
+			}
 
-		mx->Data[i] = log(arg->Data[i]) * baseLnInverse;
+			mx->Data[(i * mx->Stride) + j] = log(arg->Data[(i * arg->Stride) + j]) * baseLnInverse;
+		}
 	}
 
 	return mx;
@@ -94,17 +101,20 @@ Mx* FuncInterpretLog(ASTNode* functionCall)
 
 Mx* FuncInterpretLn(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		if (arg->Data[i] <= 0) {
-			DIAG_EMIT(DiagLogInvalidArg, functionCall->FnCall.CallArgs[0]->Loc, DIAG_ARG_NUMBER(arg->Data[i]));
-			InterpreterPanic();
-		}
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			if (arg->Data[(i * arg->Stride) + j] <= 0) {
+				DIAG_EMIT(DiagLogInvalidArg, ASTNodeChild(functionCall->FnCall.FirstArg, 0)->Loc,
+					DIAG_ARG_NUMBER(arg->Data[(i * arg->Stride) + j]));
+				InterpreterPanic();
+			}
 
-		mx->Data[i] = log(arg->Data[i]);
+			mx->Data[(i * mx->Stride) + j] = log(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -112,17 +122,20 @@ Mx* FuncInterpretLn(ASTNode* functionCall)
 
 Mx* FuncInterpretSqrt(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		if (arg->Data[i] < 0) {
-			DIAG_EMIT(DiagSqrtInvalidArg, functionCall->FnCall.CallArgs[0]->Loc, DIAG_ARG_NUMBER(arg->Data[i]));
-			InterpreterPanic();
-		}
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			if (arg->Data[(i * arg->Stride) + j] < 0) {
+				DIAG_EMIT(DiagSqrtInvalidArg, ASTNodeChild(functionCall->FnCall.FirstArg, 0)->Loc,
+					DIAG_ARG_NUMBER(arg->Data[(i * arg->Stride) + j]));
+				InterpreterPanic();
+			}
 
-		mx->Data[i] = sqrt(arg->Data[i]);
+			mx->Data[(i * mx->Stride) + j] = sqrt(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -130,12 +143,14 @@ Mx* FuncInterpretSqrt(ASTNode* functionCall)
 
 Mx* FuncInterpretAbs(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = fabs(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = fabs(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -143,12 +158,14 @@ Mx* FuncInterpretAbs(ASTNode* functionCall)
 
 Mx* FuncInterpretCeil(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = ceil(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = ceil(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -156,12 +173,14 @@ Mx* FuncInterpretCeil(ASTNode* functionCall)
 
 Mx* FuncInterpretFloor(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = floor(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = floor(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -169,12 +188,14 @@ Mx* FuncInterpretFloor(ASTNode* functionCall)
 
 Mx* FuncInterpretSin(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = sin(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = sin(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -182,12 +203,14 @@ Mx* FuncInterpretSin(ASTNode* functionCall)
 
 Mx* FuncInterpretCos(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = cos(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = cos(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -195,12 +218,14 @@ Mx* FuncInterpretCos(ASTNode* functionCall)
 
 Mx* FuncInterpretTan(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = tan(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = tan(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -208,37 +233,62 @@ Mx* FuncInterpretTan(ASTNode* functionCall)
 
 Mx* FuncInterpretCot(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	for (usz i = 0; i < arg->Shape.Height * arg->Shape.Width; ++i) {
-		mx->Data[i] = 1 / tan(arg->Data[i]);
+	for (usz i = 0; i < arg->Shape.Height; ++i) {
+		for (usz j = 0; j < arg->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = 1 / tan(arg->Data[(i * arg->Stride) + j]);
+		}
 	}
 
 	return mx;
 }
 
+// Moves rows written back to back to their padded positions, last row first so that none gets overwritten before it moved. The
+// random fills draw from the same counters whatever the padding is
+static void FuncSpreadRows(Mx* mx)
+{
+	if (MxIsContiguous(mx)) {
+		return;
+	}
+
+	for (usz i = mx->Shape.Height; i-- > 1;) {
+		memmove(mx->Data + (i * mx->Stride), mx->Data + (i * mx->Shape.Width), mx->Shape.Width * sizeof(f64));
+	}
+}
+
 Mx* FuncInterpretRand(ASTNode* functionCall)
 {
-	usz height = (usz)functionCall->FnCall.CallArgs[0]->MxLiteral.Matrix[0]->Number;
-	usz width = (usz)functionCall->FnCall.CallArgs[1]->MxLiteral.Matrix[0]->Number;
+	usz height = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 0))[0];
+	usz width = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 1))[0];
 
-	Mx* mx = InterpreterAllocMx(height, width);
+	Mx* mx = InterpreterAllocMx(functionCall, height, width);
+	RandomFillUniform(mx->Data, height * width);
+	FuncSpreadRows(mx);
 
-	for (usz i = 0; i < height * width; ++i) {
-		mx->Data[i] = (f64)rand() / ((f64)RAND_MAX + 1);
-	}
+	return mx;
+}
+
+Mx* FuncInterpretRandn(ASTNode* functionCall)
+{
+	usz height = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 0))[0];
+	usz width = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 1))[0];
+
+	Mx* mx = InterpreterAllocMx(functionCall, height, width);
+	RandomFillNormal(mx->Data, height * width);
+	FuncSpreadRows(mx);
 
 	return mx;
 }
 
 Mx* FuncInterpretInput(ASTNode* functionCall)
 {
-	usz height = (usz)functionCall->FnCall.CallArgs[0]->MxLiteral.Matrix[0]->Number;
-	usz width = (usz)functionCall->FnCall.CallArgs[1]->MxLiteral.Matrix[0]->Number;
+	usz height = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 0))[0];
+	usz width = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 1))[0];
 
-	Mx* mx = InterpreterAllocMx(height, width);
+	Mx* mx = InterpreterAllocMx(functionCall, height, width);
 	for (usz i = 0; i < height; ++i) {
 		for (usz j = 0; j < width; ++j) {
 			printf(">>> elem[%zu %zu] = ", i + 1, j + 1);
@@ -251,7 +301,7 @@ Mx* FuncInterpretInput(ASTNode* functionCall)
 				InterpreterPanic();
 			}
 
-			mx->Data[(i * width) + j] = num;
+			mx->Data[(i * mx->Stride) + j] = num;
 		}
 	}
 
@@ -260,18 +310,18 @@ Mx* FuncInterpretInput(ASTNode* functionCall)
 
 Mx* FuncInterpretReshape(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	usz height = (usz)functionCall->FnCall.CallArgs[1]->MxLiteral.Matrix[0]->Number;
-	usz width = (usz)functionCall->FnCall.CallArgs[2]->MxLiteral.Matrix[0]->Number;
+	usz height = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 1))[0];
+	usz width = (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, 2))[0];
 
-	Mx* mx = InterpreterAllocMx(height, width);
+	Mx* mx = InterpreterAllocMx(functionCall, height, width);
 	for (usz i = 0; i < height; ++i) {
 		for (usz j = 0; j < width; ++j) {
 			if (i < arg->Shape.Height && j < arg->Shape.Width) {
-				mx->Data[(i * width) + j] = arg->Data[(i * width) + j];
+				mx->Data[(i * mx->Stride) + j] = MxFlatAt(arg, (i * width) + j);
 			} else {
-				mx->Data[(i * width) + j] = 0;
+				mx->Data[(i * mx->Stride) + j] = 0;
 			}
 		}
 	}
@@ -281,12 +331,12 @@ Mx* FuncInterpretReshape(ASTNode* functionCall)
 
 Mx* FuncInterpretDiag(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* mx = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Height);
-	memset(mx->Data, 0, arg->Shape.Height * arg->Shape.Height * sizeof(f64));
+	Mx* mx = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Height);
+	memset(mx->Data, 0, arg->Shape.Height * mx->Stride * sizeof(f64));
 	for (usz i = 0; i < arg->Shape.Height; ++i) {
-		mx->Data[(i * arg->Shape.Height) + i] = arg->Data[i];
+		mx->Data[(i * mx->Stride) + i] = MxFlatAt(arg, i);
 	}
 
 	return mx;
@@ -294,13 +344,15 @@ Mx* FuncInterpretDiag(ASTNode* functionCall)
 
 Mx* FuncInterpretPow(ASTNode* functionCall)
 {
-	Mx* arg1 = InterpreterEval(functionCall->FnCall.CallArgs[0]);
-	Mx* arg2 = InterpreterEval(functionCall->FnCall.CallArgs[1]);
+	Mx* arg1 = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	Mx* arg2 = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 1));
 
-	Mx* mx = InterpreterAllocMx(arg1->Shape.Height, arg1->Shape.Width);
+	Mx* mx = InterpreterAllocMx(functionCall, arg1->Shape.Height, arg1->Shape.Width);
 
-	for (usz i = 0; i < arg1->Shape.Height * arg1->Shape.Width; ++i) {
-		mx->Data[i] = pow(arg1->Data[i], arg2->Data[i]);
+	for (usz i = 0; i < arg1->Shape.Height; ++i) {
+		for (usz j = 0; j < arg1->Shape.Width; ++j) {
+			mx->Data[(i * mx->Stride) + j] = pow(arg1->Data[(i * arg1->Stride) + j], arg2->Data[(i * arg2->Stride) + j]);
+		}
 	}
 
 	return mx;
@@ -308,119 +360,124 @@ Mx* FuncInterpretPow(ASTNode* functionCall)
 
 Mx* FuncInterpretDet(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* temp = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
-	memcpy(temp->Data, arg->Data, arg->Shape.Height * arg->Shape.Height * sizeof(f64));
+	Mx* temp = InterpreterAllocScratchMx(functionCall, arg->Shape.Height, arg->Shape.Width);
 
-	f64 det = 1.0;
-	int sign = 1;
-
-	for (usz i = 0; i < arg->Shape.Height; ++i) {
-		usz pivot = i;
-		for (usz r = i; r < arg->Shape.Height; ++r) {
-			if (fabs(temp->Data[(r * temp->Shape.Width) + i]) > fabs(temp->Data[(pivot * temp->Shape.Width) + i]))
-				pivot = r;
-		}
-
-		if (fabs(temp->Data[(pivot * temp->Shape.Width) + i]) < 1e-12) {
-			det = 0.0;
-			break;
-		}
+	Mx* out = InterpreterAllocMx(functionCall, 1, 1);
+	out->Data[0] = MxDeterminant(arg, temp);
+	return out;
+}
 
-		if (pivot != i) {
-			for (usz c = 0; c < arg->Shape.Height; ++c) {
-				f64 tmp = temp->Data[(i * temp->Shape.Width) + c];
-				temp->Data[(i * temp->Shape.Width) + c] = temp->Data[(pivot * temp->Shape.Width) + c];
-				temp->Data[(pivot * temp->Shape.Width) + c] = tmp;
-			}
+Mx* FuncInterpretInv(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-			sign = -sign;
-		}
+	Mx* temp = InterpreterAllocScratchMx(functionCall, arg->Shape.Height, 2 * arg->Shape.Height);
+	Mx* inv = InterpreterAllocMx(functionCall, arg->Shape.Height, arg->Shape.Height);
 
-		f64 piv = temp->Data[(i * temp->Shape.Width) + i];
-		det *= piv;
+	if (MxInverse(arg, inv, temp)) {
+		DIAG_EMIT0(DiagMatrixIsSingular, ASTNodeChild(functionCall->FnCall.FirstArg, 0)->Loc);
+		InterpreterPanic();
+	}
 
-		for (usz r = i + 1; r < arg->Shape.Height; ++r) {
-			f64 f = temp->Data[(r * temp->Shape.Width) + i] / piv;
+	return inv;
+}
 
-			for (usz c = i; c < arg->Shape.Height; ++c) {
-				temp->Data[(r * temp->Shape.Width) + c] -= f * temp->Data[(i * temp->Shape.Width) + c];
-			}
+static bool FuncNameIn(ASTNode* functionCall, const char* const* names, usz nameCount)
+{
+	for (usz i = 0; i < nameCount; ++i) {
+		if (functionCall->FnCall.Identifier.SymbolLength == strlen(names[i])
+			&& memcmp(functionCall->FnCall.Identifier.Symbol, names[i], functionCall->FnCall.Identifier.SymbolLength) == 0) {
+			return true;
 		}
 	}
 
-	Mx* out = InterpreterAllocMx(1, 1);
-	out->Data[0] = det * sign;
-	return out;
+	return false;
 }
 
-Mx* FuncInterpretInv(ASTNode* functionCall)
+bool FuncIsElementwise(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	static const char* const ELEMENTWISE[] = { "log", "ln", "sqrt", "abs", "ceil", "floor", "sin", "cos", "tan", "cot", "pow", "where" };
 
-	Mx* temp = InterpreterAllocMx(arg->Shape.Height, 2 * arg->Shape.Height);
-	memset(temp->Data, 0, arg->Shape.Height * 2 * arg->Shape.Height * sizeof(f64));
+	return FuncNameIn(functionCall, ELEMENTWISE, sizeof(ELEMENTWISE) / sizeof(ELEMENTWISE[0]));
+}
 
-	for (usz r = 0; r < arg->Shape.Height; ++r) {
-		for (usz c = 0; c < arg->Shape.Height; ++c)
-			temp->Data[(r * temp->Shape.Width) + c] = arg->Data[(r * arg->Shape.Width) + c];
-		temp->Data[(r * temp->Shape.Width) + r + arg->Shape.Height] = 1.0;
+usz FuncFlops(ASTNode* functionCall)
+{
+	static const char* const ONE_PER_ELEMENT[] = { "setwhere", "sum", "mean", "min", "max", "any", "all" };
+	static const char* const TWO_PER_ELEMENT[] = { "norm", "dot" };
+	static const char* const DETERMINANT[] = { "det" };
+	static const char* const RANK[] = { "rank" };
+	static const char* const INVERSE[] = { "inv" };
+
+	if (functionCall->FnCall.ArgCount < 1) {
+		return 0;
 	}
 
-	for (usz i = 0; i < arg->Shape.Height; ++i) {
-		usz pivot = i;
-		for (usz r = i; r < arg->Shape.Height; ++r) {
-			if (fabs(temp->Data[(r * temp->Shape.Width) + i]) > fabs(temp->Data[(pivot * temp->Shape.Width) + i]))
-				pivot = r;
-		}
+	// Elementwise functions work per element of their result, which log takes from its second argument and where broadcasts
+	// from all three. The rest work through their first argument
+	if (FuncIsElementwise(functionCall)) {
+		MxShape shape = TypeCheckerShapeOf(functionCall);
+		return shape.Height * shape.Width;
+	}
 
-		if (fabs(temp->Data[(pivot * temp->Shape.Width) + i]) < 1e-12) {
-			DIAG_EMIT0(DiagMatrixIsSingular, functionCall->FnCall.CallArgs[0]->Loc);
-			InterpreterPanic();
-		}
+	MxShape arg = TypeCheckerShapeOf(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz elements = arg.Height * arg.Width;
 
-		if (pivot != i) {
-			for (usz c = 0; c < 2 * arg->Shape.Height; ++c) {
-				f64 tmp = temp->Data[(i * temp->Shape.Width) + c];
-				temp->Data[(i * temp->Shape.Width) + c] = temp->Data[(pivot * temp->Shape.Width) + c];
-				temp->Data[(pivot * temp->Shape.Width) + c] = tmp;
-			}
-		}
+	if (FuncNameIn(functionCall, ONE_PER_ELEMENT, sizeof(ONE_PER_ELEMENT) / sizeof(ONE_PER_ELEMENT[0]))) {
+		return elements;
+	}
 
-		f64 piv = temp->Data[(i * temp->Shape.Width) + i];
-		for (usz c = 0; c < 2 * arg->Shape.Height; ++c) {
-			temp->Data[(i * temp->Shape.Width) + c] /= piv;
-		}
+	if (FuncNameIn(functionCall, TWO_PER_ELEMENT, sizeof(TWO_PER_ELEMENT) / sizeof(TWO_PER_ELEMENT[0]))) {
+		return 2 * elements;
+	}
 
-		for (usz r = 0; r < arg->Shape.Height; ++r) {
-			if (r == i) {
-				continue;
-			}
+	// Det only eliminates below every pivot. Rank and inv eliminate above it too, inv also carries the appended identity
+	// through every row operation
+	if (FuncNameIn(functionCall, DETERMINANT, sizeof(DETERMINANT) / sizeof(DETERMINANT[0]))) {
+		return 2 * arg.Height * elements / 3;
+	}
 
-			f64 f = temp->Data[(r * temp->Shape.Width) + i];
-			for (usz c = 0; c < 2 * arg->Shape.Height; ++c) {
-				temp->Data[(r * temp->Shape.Width) + c] -= f * temp->Data[(i * temp->Shape.Width) + c];
-			}
-		}
+	if (FuncNameIn(functionCall, RANK, sizeof(RANK) / sizeof(RANK[0]))) {
+		usz pivots = arg.Height < arg.Width ? arg.Height : arg.Width;
+		return 2 * arg.Height * (arg.Width * pivots - (pivots * pivots / 2));
 	}
 
-	Mx* inv = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Height);
-	for (usz r = 0; r < arg->Shape.Height; ++r) {
-		for (usz c = 0; c < arg->Shape.Height; ++c) {
-			inv->Data[(r * inv->Shape.Width) + c] = temp->Data[(r * temp->Shape.Width) + c + arg->Shape.Height];
-		}
+	if (FuncNameIn(functionCall, INVERSE, sizeof(INVERSE) / sizeof(INVERSE[0]))) {
+		return 4 * arg.Height * elements;
 	}
 
-	return inv;
+	return 0;
+}
+
+// Det, rank and inv eliminate on a copy of their argument, the one of inv has the identity appended to it
+MxShape FuncScratchShape(ASTNode* functionCall)
+{
+	if (functionCall->FnCall.ArgCount < 1) {
+		return NO_SHAPE;
+	}
+
+	MxShape arg = TypeCheckerShapeOf(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+
+	if ((functionCall->FnCall.Identifier.SymbolLength == 3 && memcmp(functionCall->FnCall.Identifier.Symbol, "det", 3) == 0)
+		|| (functionCall->FnCall.Identifier.SymbolLength == 4 && memcmp(functionCall->FnCall.Identifier.Symbol, "rank", 4) == 0)) {
+		return arg;
+	}
+
+	if (functionCall->FnCall.Identifier.SymbolLength == 3 && memcmp(functionCall->FnCall.Identifier.Symbol, "inv", 3) == 0) {
+		return (MxShape) { arg.Height, 2 * arg.Height };
+	}
+
+	return NO_SHAPE;
 }
 
 Mx* FuncInterpretRank(ASTNode* functionCall)
 {
-	Mx* arg = InterpreterEval(functionCall->FnCall.CallArgs[0]);
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
 
-	Mx* temp = InterpreterAllocMx(arg->Shape.Height, arg->Shape.Width);
-	memcpy(temp->Data, arg->Data, arg->Shape.Height * arg->Shape.Width * sizeof(f64));
+	Mx* temp = InterpreterAllocScratchMx(functionCall, arg->Shape.Height, arg->Shape.Width);
+	MxCopy(arg, temp);
 
 	usz rank = 0;
 	usz row = 0;
@@ -428,26 +485,26 @@ Mx* FuncInterpretRank(ASTNode* functionCall)
 	for (usz col = 0; col < arg->Shape.Width && row < arg->Shape.Height; ++col) {
 		usz pivot = row;
 		for (usz r = row; r < arg->Shape.Height; ++r) {
-			if (fabs(temp->Data[(r * arg->Shape.Width) * col]) > fabs(temp->Data[(pivot * arg->Shape.Width) * col])) {
+			if (fabs(temp->Data[(r * temp->Stride) + col]) > fabs(temp->Data[(pivot * temp->Stride) + col])) {
 				pivot = r;
 			}
 		}
 
-		if (fabs(temp->Data[(pivot * arg->Shape.Width) * col]) < 1e-12) {
+		if (fabs(temp->Data[(pivot * temp->Stride) + col]) < 1e-12) {
 			continue;
 		}
 
 		if (pivot != row) {
 			for (usz c = 0; c < arg->Shape.Width; ++c) {
-				f64 tmp = temp->Data[(row * arg->Shape.Width) * c];
-				temp->Data[(row * arg->Shape.Width) * c] = temp->Data[(pivot * arg->Shape.Width) * c];
-				temp->Data[(pivot * arg->Shape.Width) * c] = tmp;
+				f64 tmp = temp->Data[(row * temp->Stride) + c];
+				temp->Data[(row * temp->Stride) + c] = temp->Data[(pivot * temp->Stride) + c];
+				temp->Data[(pivot * temp->Stride) + c] = tmp;
 			}
 		}
 
-		f64 piv = temp->Data[(row * arg->Shape.Width) * col];
+		f64 piv = temp->Data[(row * temp->Stride) + col];
 		for (usz c = col; c < arg->Shape.Width; ++c) {
-			temp->Data[(row * arg->Shape.Width) * c] /= piv;
+			temp->Data[(row * temp->Stride) + c] /= piv;
 		}
 
 		for (usz r = 0; r < arg->Shape.Height; ++r) {
@@ -455,9 +512,9 @@ Mx* FuncInterpretRank(ASTNode* functionCall)
 				continue;
 			}
 
-			f64 f = temp->Data[(r * arg->Shape.Width) * col];
+			f64 f = temp->Data[(r * temp->Stride) + col];
 			for (usz c = col; c < arg->Shape.Width; ++c) {
-				temp->Data[(r * arg->Shape.Width) * c] -= f * temp->Data[(row * arg->Shape.Width) * c];
+				temp->Data[(r * temp->Stride) + c] -= f * temp->Data[(row * temp->Stride) + c];
 			}
 		}
 
@@ -465,7 +522,315 @@ Mx* FuncInterpretRank(ASTNode* functionCall)
 		rank++;
 	}
 
-	Mx* out = InterpreterAllocMx(1, 1);
+	Mx* out = InterpreterAllocMx(functionCall, 1, 1);
 	out->Data[0] = (f64)rank;
 	return out;
 }
+
+// Reductions are expressed as a step (folding one element into an accumulator), a merge (combining two partial accumulators)
+// and a finish (turning the accumulator into the final value). The drivers below are `static inline` so that the steps get
+// inlined into the loops, which lets the compiler vectorize them
+typedef f64 (*ReductionFn)(f64 acc, f64 value);
+typedef f64 (*ReductionFinishFn)(f64 acc, usz count);
+
+static f64 ReductionSum(f64 acc, f64 value) { return acc + value; }
+
+static f64 ReductionSumSquares(f64 acc, f64 value) { return acc + (value * value); }
+
+static f64 ReductionMin(f64 acc, f64 value) { return value < acc ? value : acc; }
+
+static f64 ReductionMax(f64 acc, f64 value) { return value > acc ? value : acc; }
+
+static f64 ReductionCountNonZero(f64 acc, f64 value) { return acc + (f64)(value != 0); }
+
+static f64 ReductionCountZero(f64 acc, f64 value) { return acc + (f64)(value == 0); }
+
+static f64 ReductionFinishNone(f64 acc, usz count)
+{
+	(void)count;
+	return acc;
+}
+
+static f64 ReductionFinishMean(f64 acc, usz count) { return acc / (f64)count; }
+
+static f64 ReductionFinishSqrt(f64 acc, usz count)
+{
+	(void)count;
+	return sqrt(acc);
+}
+
+static f64 ReductionFinishNonZero(f64 acc, usz count)
+{
+	(void)count;
+	return (f64)(acc != 0);
+}
+
+static f64 ReductionFinishZero(f64 acc, usz count)
+{
+	(void)count;
+	return (f64)(acc == 0);
+}
+
+// Folds a contiguous range using 4 independent accumulators, so that consecutive steps do not depend on each other
+static inline f64 ReduceRange(const f64* data, usz count, f64 identity, ReductionFn step, ReductionFn merge)
+{
+	f64 acc0 = identity;
+	f64 acc1 = identity;
+	f64 acc2 = identity;
+	f64 acc3 = identity;
+
+	usz i = 0;
+	for (; i + 4 <= count; i += 4) {
+		acc0 = step(acc0, data[i]);
+		acc1 = step(acc1, data[i + 1]);
+		acc2 = step(acc2, data[i + 2]);
+		acc3 = step(acc3, data[i + 3]);
+	}
+
+	for (; i < count; ++i) {
+		acc0 = step(acc0, data[i]);
+	}
+
+	return merge(merge(acc0, acc1), merge(acc2, acc3));
+}
+
+// `dim` is 0 for a whole-matrix reduction, 1 for a column-wise one (yielding a row vector) and 2 for a row-wise one (yielding a
+// column vector)
+static inline void Reduce(const Mx* arg, Mx* out, usz dim, f64 identity, ReductionFn step, ReductionFn merge, ReductionFinishFn finish)
+{
+	usz height = arg->Shape.Height;
+	usz width = arg->Shape.Width;
+
+	if (dim == 0) {
+		if (MxIsContiguous(arg)) {
+			out->Data[0] = finish(ReduceRange(arg->Data, height * width, identity, step, merge), height * width);
+			return;
+		}
+
+		// Padded rows get folded one at a time, skipping the padding between them
+		f64 acc = identity;
+		for (usz i = 0; i < height; ++i) {
+			acc = merge(acc, ReduceRange(arg->Data + (i * arg->Stride), width, identity, step, merge));
+		}
+
+		out->Data[0] = finish(acc, height * width);
+		return;
+	}
+
+	if (dim == 2) {
+		for (usz i = 0; i < height; ++i) {
+			out->Data[i * out->Stride] = finish(ReduceRange(arg->Data + (i * arg->Stride), width, identity, step, merge), width);
+		}
+
+		return;
+	}
+
+	// Column-wise reductions walk the matrix row by row, so that both the input and the accumulators are read contiguously
+	for (usz j = 0; j < width; ++j) {
+		out->Data[j] = identity;
+	}
+
+	for (usz i = 0; i < height; ++i) {
+		const f64* row = arg->Data + (i * arg->Stride);
+
+		for (usz j = 0; j < width; ++j) {
+			out->Data[j] = step(out->Data[j], row[j]);
+		}
+	}
+
+	for (usz j = 0; j < width; ++j) {
+		out->Data[j] = finish(out->Data[j], height);
+	}
+}
+
+static usz ReductionDim(ASTNode* functionCall, usz dimArgIndex)
+{
+	if (functionCall->FnCall.ArgCount <= dimArgIndex) {
+		return 0;
+	}
+
+	return (usz)ASTNodeValues(ASTNodeChild(functionCall->FnCall.FirstArg, dimArgIndex))[0];
+}
+
+static Mx* ReductionAllocMx(ASTNode* functionCall, const Mx* arg, usz dim)
+{
+	switch (dim) {
+	case 1:
+		return InterpreterAllocMx(functionCall, 1, arg->Shape.Width);
+	case 2:
+		return InterpreterAllocMx(functionCall, arg->Shape.Height, 1);
+	default:
+		return InterpreterAllocMx(functionCall, 1, 1);
+	}
+}
+
+Mx* FuncInterpretSum(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, 0, ReductionSum, ReductionSum, ReductionFinishNone);
+
+	return mx;
+}
+
+Mx* FuncInterpretMean(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, 0, ReductionSum, ReductionSum, ReductionFinishMean);
+
+	return mx;
+}
+
+Mx* FuncInterpretMin(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, INFINITY, ReductionMin, ReductionMin, ReductionFinishNone);
+
+	return mx;
+}
+
+Mx* FuncInterpretMax(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, -INFINITY, ReductionMax, ReductionMax, ReductionFinishNone);
+
+	return mx;
+}
+
+Mx* FuncInterpretNorm(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, 0, ReductionSumSquares, ReductionSum, ReductionFinishSqrt);
+
+	return mx;
+}
+
+Mx* FuncInterpretAny(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, 0, ReductionCountNonZero, ReductionSum, ReductionFinishNonZero);
+
+	return mx;
+}
+
+Mx* FuncInterpretAll(ASTNode* functionCall)
+{
+	Mx* arg = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	usz dim = ReductionDim(functionCall, 1);
+
+	Mx* mx = ReductionAllocMx(functionCall, arg, dim);
+	Reduce(arg, mx, dim, 0, ReductionCountZero, ReductionSum, ReductionFinishZero);
+
+	return mx;
+}
+
+Mx* FuncInterpretDot(ASTNode* functionCall)
+{
+	Mx* left = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	Mx* right = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 1));
+	usz dim = ReductionDim(functionCall, 2);
+
+	usz height = left->Shape.Height;
+	usz width = left->Shape.Width;
+
+	Mx* mx = ReductionAllocMx(functionCall, left, dim);
+
+	if (dim == 1) {
+		memset(mx->Data, 0, width * sizeof(f64));
+
+		for (usz i = 0; i < height; ++i) {
+			for (usz j = 0; j < width; ++j) {
+				mx->Data[j] += left->Data[(i * left->Stride) + j] * right->Data[(i * right->Stride) + j];
+			}
+		}
+
+		return mx;
+	}
+
+	// A whole-matrix dot product of contiguous operands is just a single row spanning all the elements, padded ones get summed up
+	// row by row
+	bool whole = dim != 2;
+	bool flat = whole && MxIsContiguous(left) && MxIsContiguous(right);
+	usz rows = flat ? 1 : height;
+	usz rowLength = flat ? height * width : width;
+
+	if (whole) {
+		mx->Data[0] = 0;
+	}
+
+	for (usz i = 0; i < rows; ++i) {
+		const f64* l = left->Data + (i * left->Stride);
+		const f64* r = right->Data + (i * right->Stride);
+
+		f64 acc0 = 0;
+		f64 acc1 = 0;
+		f64 acc2 = 0;
+		f64 acc3 = 0;
+
+		usz k = 0;
+		for (; k + 4 <= rowLength; k += 4) {
+			acc0 += l[k] * r[k];
+			acc1 += l[k + 1] * r[k + 1];
+			acc2 += l[k + 2] * r[k + 2];
+			acc3 += l[k + 3] * r[k + 3];
+		}
+
+		for (; k < rowLength; ++k) {
+			acc0 += l[k] * r[k];
+		}
+
+		f64 acc = (acc0 + acc1) + (acc2 + acc3);
+		if (whole) {
+			mx->Data[0] += acc;
+		} else {
+			mx->Data[i * mx->Stride] = acc;
+		}
+	}
+
+	return mx;
+}
+
+Mx* FuncInterpretWhere(ASTNode* functionCall)
+{
+	Mx* mask = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 0));
+	Mx* onTrue = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 1));
+	Mx* onFalse = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 2));
+
+	MxShape valuesShape = { 0 };
+	MxShape shape;
+	MxBroadcastShape(&onTrue->Shape, &onFalse->Shape, &valuesShape);
+	MxBroadcastShape(&mask->Shape, &valuesShape, &shape);
+
+	Mx* mx = InterpreterAllocMx(functionCall, shape.Height, shape.Width);
+	MxSelect(mask, onTrue, onFalse, mx);
+
+	return mx;
+}
+
+Mx* FuncInterpretSetWhere(ASTNode* functionCall)
+{
+	Mx* var = g_interpreter.VarTable[ASTNodeChild(functionCall->FnCall.FirstArg, 0)->Identifier.ID];
+	Mx* mask = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 1));
+	Mx* value = InterpreterEval(ASTNodeChild(functionCall->FnCall.FirstArg, 2));
+
+	MxSelect(mask, value, var, var);
+
+	return nullptr;
+}
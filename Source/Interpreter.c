@@ -2,21 +2,81 @@
 
 #include "Diagnostics.h"
 #include "Functions.h"
+#include "MemReport.h"
 #include "Mx.h"
+#include "Planner.h"
+#include "Profile.h"
+#include "TypeChecker.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 Interpreter g_interpreter = { 0 };
 
-void InterpreterInit()
+#ifndef _WIN32
+static constexpr usz INTERPRETER_HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+// Anonymous mappings only get backed by memory once touched. Pages from the reserved huge page pool are tried first, then
+// transparent huge pages, which the kernel is free to ignore. The slab starts on a huge page boundary either way
+static bool InterpreterMapSlab()
+{
+	usz length = AlignUp(g_planner.SlabBytes, INTERPRETER_HUGE_PAGE_BYTES);
+
+#ifdef MAP_HUGETLB
+	void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (mapping != MAP_FAILED) {
+		g_interpreter.SlabMemory = mapping;
+		g_interpreter.SlabMappingBytes = length;
+		g_interpreter.Slab = mapping;
+		return true;
+	}
+#endif
+
+	// Regular pages are only guaranteed to be page aligned, the extra huge page makes room for aligning the slab
+	length += INTERPRETER_HUGE_PAGE_BYTES;
+	void* regular = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (regular == MAP_FAILED) {
+		return false;
+	}
+
+	g_interpreter.SlabMemory = regular;
+	g_interpreter.SlabMappingBytes = length;
+	g_interpreter.Slab = (u8*)AlignUp((usz)regular, INTERPRETER_HUGE_PAGE_BYTES);
+
+#ifdef MADV_HUGEPAGE
+	madvise(g_interpreter.Slab, length - INTERPRETER_HUGE_PAGE_BYTES, MADV_HUGEPAGE);
+#endif
+
+	return true;
+}
+#endif
+
+void InterpreterInit(bool hugePages)
 {
-	g_interpreter.VarTable = (Mx**)calloc(128, sizeof(Mx*));
-	if (!g_interpreter.VarTable) {
+	g_interpreter.VarTable = (Mx**)calloc(g_typeChecker.VarSlotCount, sizeof(Mx*));
+	if (!g_interpreter.VarTable && g_typeChecker.VarSlotCount > 0) {
 		DIAG_PANIC_ON_ERR(ResOutOfMemory);
 	}
 
-	DIAG_PANIC_ON_ERR(DynArenaInit(&g_interpreter.MxArena));
+	// Every matrix the program will ever need already has its place, this is the only allocation made for them
+#ifdef _WIN32
+	(void)hugePages;
+#else
+	if (hugePages && InterpreterMapSlab()) {
+		return;
+	}
+#endif
+
+	g_interpreter.SlabMemory = malloc(g_planner.SlabBytes + PLANNER_ALIGNMENT - 1);
+	if (!g_interpreter.SlabMemory) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	g_interpreter.Slab = (u8*)AlignUp((usz)g_interpreter.SlabMemory, PLANNER_ALIGNMENT);
 }
 
 [[noreturn]] void InterpreterPanic()
@@ -28,38 +88,114 @@ void InterpreterInit()
 	exit(1);
 }
 
-Mx* InterpreterAllocMx(usz height, usz width)
+Mx* InterpreterAllocMx(ASTNode* node, usz height, usz width)
+{
+	// Results written over an operand did not take any new memory
+	if (g_profile.Enabled && !PlannerIsInPlace(node)) {
+		ProfileMx(node, PlannerMxBytes((MxShape) { height, width }));
+	}
+
+	return MxPlace(g_interpreter.Slab + g_planner.Offsets[ASTNodeIDOf(node)], (MxShape) { height, width });
+}
+
+Mx* InterpreterAllocScratchMx(ASTNode* node, usz height, usz width)
 {
-	Mx* mx;
-	DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_interpreter.MxArena, (void**)&mx, sizeof(Mx) + (height * width * sizeof(f64))));
+	usz offset = g_planner.Offsets[ASTNodeIDOf(node)] + PlannerMxBytes(TypeCheckerShapeOf(node));
+	if (g_profile.Enabled) {
+		ProfileMx(node, PlannerMxBytes((MxShape) { height, width }));
+	}
 
-	mx->Shape.Height = height;
-	mx->Shape.Width = width;
+	return MxPlace(g_interpreter.Slab + offset, (MxShape) { height, width });
+}
 
-	return mx;
+static Mx* InterpreterAllocBroadcastMx(ASTNode* node, const Mx* left, const Mx* right)
+{
+	MxShape shape;
+	MxBroadcastShape(&left->Shape, &right->Shape, &shape);
+
+	return InterpreterAllocMx(node, shape.Height, shape.Width);
 }
 
-Mx* InterpreterEval(ASTNode* node)
+// Evaluates a single dimension of an index suffix into a 0-based start and an element count. Range bounds have already been
+// validated by the type checker
+static usz InterpreterEvalIndex(ASTNode* index, const Mx* var, usz dimSize, usz* count)
 {
+	if (index->Type == ASTNodeRange) {
+		if (!index->Range.Start) {
+			*count = dimSize;
+			return 0;
+		}
+
+		usz start = (usz)ASTNodeValues(ASTNodeGet(index->Range.Start))[0];
+		usz end = (usz)ASTNodeValues(ASTNodeGet(index->Range.End))[0];
+
+		*count = end - start + 1;
+		return start - 1;
+	}
+
+	Mx* mx = InterpreterEval(index);
+
+	if (!IsF64Int(mx->Data[0])) {
+		DIAG_EMIT(DiagIndexNotInteger, index->Loc, DIAG_ARG_NUMBER(mx->Data[0]));
+		InterpreterPanic();
+	}
+
+	usz i = (usz)mx->Data[0];
+
+	if (i < 1 || i > dimSize) {
+		DIAG_EMIT(DiagIndexOutOfRange, index->Loc, DIAG_ARG_NUMBER(mx->Data[0]), DIAG_ARG_MX_SHAPE(var->Shape));
+		InterpreterPanic();
+	}
+
+	*count = 1;
+	return i - 1;
+}
+
+// Resolves an index suffix into a view of the selected part of a variable, without copying anything
+static MxView InterpreterEvalIndexSuffix(ASTNode* indexSuffix, Mx* var)
+{
+	MxShape shape;
+	usz row = InterpreterEvalIndex(ASTNodeGet(indexSuffix->IndexSuffix.I), var, var->Shape.Height, &shape.Height);
+	usz col = 0;
+
+	if (indexSuffix->IndexSuffix.J) {
+		col = InterpreterEvalIndex(ASTNodeGet(indexSuffix->IndexSuffix.J), var, var->Shape.Width, &shape.Width);
+	} else {
+		shape.Width = var->Shape.Width;
+	}
+
+	return MxViewOf(var, row, col, shape);
+}
+
+static Mx* InterpreterEvalNode(ASTNode* node)
+{
+	++g_interpreter.EvalCounts[node->Type];
+
 	switch (node->Type) {
 	case ASTNodeNumber: {
-		Mx* num = InterpreterAllocMx(1, 1);
-		num->Data[0] = node->Number;
-		return num;
+		Mx* mx = InterpreterAllocMx(node, node->Number.Shape.Height, node->Number.Shape.Width);
+
+		MxView values = { .Shape = node->Number.Shape, .Stride = node->Number.Shape.Width, .Data = ASTNodeValues(node) };
+		MxView out = MxViewOf(mx, 0, 0, mx->Shape);
+
+		MxViewCopy(&values, &out);
+		return mx;
 	}
 	case ASTNodeMxLiteral: {
-		Mx* mx = InterpreterAllocMx(node->MxLiteral.Shape.Height, node->MxLiteral.Shape.Width);
+		Mx* mx = InterpreterAllocMx(node, node->MxLiteral.Shape.Height, node->MxLiteral.Shape.Width);
 
-		for (usz i = 0; i < node->MxLiteral.Shape.Height * node->MxLiteral.Shape.Width; ++i) {
-			Mx* num = InterpreterEval(node->MxLiteral.Matrix[i]);
+		for (usz i = 0; i < mx->Shape.Height; ++i) {
+			for (usz j = 0; j < mx->Shape.Width; ++j) {
+				Mx* num = InterpreterEval(ASTNodeChild(node->MxLiteral.FirstElement, (i * mx->Shape.Width) + j));
 
-			mx->Data[i] = num->Data[0];
+				mx->Data[(i * mx->Stride) + j] = num->Data[0];
+			}
 		}
 
 		return mx;
 	}
 	case ASTNodeUnary: {
-		Mx* operand = InterpreterEval(node->Unary.Operand);
+		Mx* operand = InterpreterEval(ASTNodeGet(node->Unary.Operand));
 
 		switch (node->Unary.Operator) {
 		case TokenSubtract: {
@@ -67,7 +203,7 @@ Mx* InterpreterEval(ASTNode* node)
 			return operand;
 		}
 		case TokenTranspose: {
-			Mx* mx = InterpreterAllocMx(operand->Shape.Width, operand->Shape.Height);
+			Mx* mx = InterpreterAllocMx(node, operand->Shape.Width, operand->Shape.Height);
 			MxTranspose(operand, mx);
 			return mx;
 		}
@@ -77,45 +213,46 @@ Mx* InterpreterEval(ASTNode* node)
 		}
 	}
 	case ASTNodeGrouping:
-		return InterpreterEval(node->Grouping.Expression);
+		return InterpreterEval(ASTNodeGet(node->Grouping.Expression));
 	case ASTNodeBinary: {
-		Mx* left = InterpreterEval(node->Binary.Left);
-		Mx* right = InterpreterEval(node->Binary.Right);
+		Mx* left = InterpreterEval(ASTNodeGet(node->Binary.Left));
+		Mx* right = InterpreterEval(ASTNodeGet(node->Binary.Right));
 
 		switch (node->Binary.Operator) {
 		case TokenAdd: {
-			Mx* mx = nullptr;
-
-			if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-				mx = InterpreterAllocMx(right->Shape.Height, right->Shape.Width);
-			} else {
-				mx = InterpreterAllocMx(left->Shape.Height, left->Shape.Width);
-			}
-
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
 			MxAdd(left, right, mx);
 			return mx;
 		}
 		case TokenSubtract: {
-			Mx* mx = nullptr;
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxSubtract(left, right, mx);
+			return mx;
+		}
+		case TokenElementMultiply: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementMultiply(left, right, mx);
+			return mx;
+		}
+		case TokenElementDivide: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
 
-			if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-				mx = InterpreterAllocMx(right->Shape.Height, right->Shape.Width);
-			} else {
-				mx = InterpreterAllocMx(left->Shape.Height, left->Shape.Width);
+			Result result = MxElementDivide(left, right, mx);
+			if (result) {
+				DIAG_EMIT0(DiagDivisionByZero, ASTNodeGet(node->Binary.Right)->Loc);
+				InterpreterPanic();
 			}
-
-			MxSubtract(left, right, mx);
 			return mx;
 		}
 		case TokenMultiply: {
 			Mx* mx = nullptr;
 
 			if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-				mx = InterpreterAllocMx(right->Shape.Height, right->Shape.Width);
+				mx = InterpreterAllocMx(node, right->Shape.Height, right->Shape.Width);
 			} else if (right->Shape.Height == 1 && right->Shape.Width == 1) {
-				mx = InterpreterAllocMx(left->Shape.Height, left->Shape.Width);
+				mx = InterpreterAllocMx(node, left->Shape.Height, left->Shape.Width);
 			} else {
-				mx = InterpreterAllocMx(left->Shape.Height, right->Shape.Width);
+				mx = InterpreterAllocMx(node, left->Shape.Height, right->Shape.Width);
 			}
 
 			MxMultiply(left, right, mx);
@@ -125,64 +262,96 @@ Mx* InterpreterEval(ASTNode* node)
 			Mx* mx = nullptr;
 
 			if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-				mx = InterpreterAllocMx(right->Shape.Height, right->Shape.Width);
+				mx = InterpreterAllocMx(node, right->Shape.Height, right->Shape.Width);
 			} else if (right->Shape.Height == 1 && right->Shape.Width == 1) {
-				mx = InterpreterAllocMx(left->Shape.Height, left->Shape.Width);
+				mx = InterpreterAllocMx(node, left->Shape.Height, left->Shape.Width);
 			}
 
 			Result result = MxDivide(left, right, mx);
 			if (result) {
-				DIAG_EMIT0(DiagDivisionByZero, node->Binary.Right->Loc);
+				DIAG_EMIT0(DiagDivisionByZero, ASTNodeGet(node->Binary.Right)->Loc);
 				InterpreterPanic();
 			}
 			return mx;
 		}
 		case TokenToPower: {
-			Mx* mx = InterpreterAllocMx(left->Shape.Height, left->Shape.Width);
-			Result result = MxToPower(left, right, mx);
+			Mx* mx = InterpreterAllocMx(node, left->Shape.Height, left->Shape.Width);
+			Mx* temp = InterpreterAllocScratchMx(node, left->Shape.Height, left->Shape.Width);
+
+			Result result = MxToPower(left, right, mx, temp);
 			if (result) {
-				DIAG_EMIT(DiagPoweringToNonInt, node->Binary.Right->Loc, DIAG_ARG_NUMBER(right->Data[0]));
+				DIAG_EMIT(DiagPoweringToNonInt, ASTNodeGet(node->Binary.Right)->Loc, DIAG_ARG_NUMBER(right->Data[0]));
 				InterpreterPanic();
 			}
 			return mx;
 		}
 		case TokenGreater: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxGreater(left, right, mx);
 			return mx;
 		}
 		case TokenGreaterEqual: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxGreaterEqual(left, right, mx);
 			return mx;
 		}
 		case TokenLess: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxLess(left, right, mx);
 			return mx;
 		}
 		case TokenLessEqual: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxLessEqual(left, right, mx);
 			return mx;
 		}
 		case TokenEqualEqual: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxEqualEqual(left, right, mx);
 			return mx;
 		}
 		case TokenNotEqual: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxNotEqual(left, right, mx);
 			return mx;
 		}
+		case TokenElementGreater: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementGreater(left, right, mx);
+			return mx;
+		}
+		case TokenElementGreaterEqual: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementGreaterEqual(left, right, mx);
+			return mx;
+		}
+		case TokenElementLess: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementLess(left, right, mx);
+			return mx;
+		}
+		case TokenElementLessEqual: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementLessEqual(left, right, mx);
+			return mx;
+		}
+		case TokenElementEqualEqual: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementEqualEqual(left, right, mx);
+			return mx;
+		}
+		case TokenElementNotEqual: {
+			Mx* mx = InterpreterAllocBroadcastMx(node, left, right);
+			MxElementNotEqual(left, right, mx);
+			return mx;
+		}
 		case TokenOr: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxLogicalOr(left, right, mx);
 			return mx;
 		}
 		case TokenAnd: {
-			Mx* mx = InterpreterAllocMx(1, 1);
+			Mx* mx = InterpreterAllocMx(node, 1, 1);
 			MxLogicalOr(left, right, mx);
 			return mx;
 		}
@@ -193,31 +362,36 @@ Mx* InterpreterEval(ASTNode* node)
 	}
 	case ASTNodeBlock: {
 		for (usz i = 0; i < node->Block.NodeCount; ++i) {
-			InterpreterEval(node->Block.Nodes[i]);
+			InterpreterEval(ASTNodeChild(node->Block.FirstNode, i));
 		}
 
 		return nullptr;
 	}
 	case ASTNodeIfStmt: {
-		Mx* cond = InterpreterEval(node->IfStmt.Condition);
+		Mx* cond = InterpreterEval(ASTNodeGet(node->IfStmt.Condition));
 
 		if (MxTruthy(cond)) {
-			InterpreterEval(node->IfStmt.ThenBlock);
+			InterpreterEval(ASTNodeGet(node->IfStmt.ThenBlock));
 		} else if (node->IfStmt.ElseBlock) {
-			InterpreterEval(node->IfStmt.ElseBlock);
+			InterpreterEval(ASTNodeGet(node->IfStmt.ElseBlock));
 		}
 
 		return nullptr;
 	}
 	case ASTNodeWhileStmt: {
 		while (true) {
-			Mx* cond = InterpreterEval(node->WhileStmt.Condition);
+			Mx* cond = InterpreterEval(ASTNodeGet(node->WhileStmt.Condition));
 
 			if (!MxTruthy(cond)) {
 				break;
 			}
 
-			InterpreterEval(node->WhileStmt.Body);
+			InterpreterEval(ASTNodeGet(node->WhileStmt.Body));
+
+			// Long running programs spend their time in loops, so that is where reports asked for by signal get printed
+			if (g_memReportPending) {
+				MemReportPrint();
+			}
 		}
 
 		return nullptr;
@@ -225,62 +399,29 @@ Mx* InterpreterEval(ASTNode* node)
 	case ASTNodeVarDecl: {
 		usz id = node->VarDecl.ID;
 
-		g_interpreter.VarTable[id] = InterpreterAllocMx(node->VarDecl.Shape.Height, node->VarDecl.Shape.Width);
+		g_interpreter.VarTable[id] = InterpreterAllocMx(node, node->VarDecl.Shape.Height, node->VarDecl.Shape.Width);
 
 		if (node->VarDecl.Expression) {
-			Mx* initExpr = InterpreterEval(node->VarDecl.Expression);
+			Mx* initExpr = InterpreterEval(ASTNodeGet(node->VarDecl.Expression));
 
-			for (usz i = 0; i < node->VarDecl.Shape.Height * node->VarDecl.Shape.Width; ++i) {
-				g_interpreter.VarTable[id]->Data[i] = initExpr->Data[i];
-			}
+			MxCopy(initExpr, g_interpreter.VarTable[id]);
 		}
 
 		return nullptr;
 	}
 	case ASTNodeAssignment: {
-		Mx* newVal = InterpreterEval(node->Assignment.Expression);
+		Mx* newVal = InterpreterEval(ASTNodeGet(node->Assignment.Expression));
 
 		usz id = node->Assignment.ID;
 		Mx* var = g_interpreter.VarTable[id];
 
 		if (!node->Assignment.Index) {
-			memcpy(var->Data, newVal->Data, var->Shape.Height * var->Shape.Width * sizeof(f64));
+			MxCopy(newVal, var);
 		} else {
-			Mx* mxI = InterpreterEval(node->Assignment.Index->IndexSuffix.I);
-
-			if (!IsF64Int(mxI->Data[0])) {
-				DIAG_EMIT(DiagIndexNotInteger, node->Assignment.Index->IndexSuffix.I->Loc, DIAG_ARG_NUMBER(mxI->Data[0]));
-				InterpreterPanic();
-			}
-
-			usz i = (usz)mxI->Data[0];
-
-			if (i < 1 || i > var->Shape.Height) {
-				DIAG_EMIT(DiagIndexOutOfRange, node->Assignment.Index->IndexSuffix.I->Loc, DIAG_ARG_NUMBER(mxI->Data[0]),
-					DIAG_ARG_MX_SHAPE(var->Shape));
-				InterpreterPanic();
-			}
-
-			if (node->Assignment.Index->IndexSuffix.J) {
-				Mx* mxJ = InterpreterEval(node->Assignment.Index->IndexSuffix.J);
-
-				if (!IsF64Int(mxJ->Data[0])) {
-					DIAG_EMIT(DiagIndexNotInteger, node->Assignment.Index->IndexSuffix.J->Loc, DIAG_ARG_NUMBER(mxJ->Data[0]));
-					InterpreterPanic();
-				}
-
-				usz j = (usz)mxJ->Data[0];
-
-				if (j < 1 || j > var->Shape.Width) {
-					DIAG_EMIT(DiagIndexOutOfRange, node->Assignment.Index->IndexSuffix.J->Loc, DIAG_ARG_NUMBER(mxJ->Data[0]),
-						DIAG_ARG_MX_SHAPE(var->Shape));
-					InterpreterPanic();
-				}
+			MxView slice = InterpreterEvalIndexSuffix(ASTNodeGet(node->Assignment.Index), var);
+			MxView value = MxViewOf(newVal, 0, 0, newVal->Shape);
 
-				var->Data[((i - 1) * var->Shape.Width) + j - 1] = newVal->Data[0];
-			} else {
-				memcpy(var->Data + ((i - 1) * var->Shape.Width), newVal->Data, newVal->Shape.Width * sizeof(f64));
-			}
+			MxViewCopy(&value, &slice);
 		}
 
 		return nullptr;
@@ -342,6 +483,10 @@ Mx* InterpreterEval(ASTNode* node)
 			return FuncInterpretRand(node);
 		}
 
+		if (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "randn", 5) == 0) {
+			return FuncInterpretRandn(node);
+		}
+
 		if (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "input", 5) == 0) {
 			return FuncInterpretInput(node);
 		}
@@ -370,56 +515,64 @@ Mx* InterpreterEval(ASTNode* node)
 			return FuncInterpretRank(node);
 		}
 
-		return nullptr;
-	}
-	case ASTNodeIdentifier: {
-		usz id = node->Identifier.ID;
-		Mx* var = g_interpreter.VarTable[id];
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "sum", 3) == 0) {
+			return FuncInterpretSum(node);
+		}
 
-		if (node->Identifier.Index) {
-			Mx* mxI = InterpreterEval(node->Identifier.Index->IndexSuffix.I);
+		if (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "mean", 4) == 0) {
+			return FuncInterpretMean(node);
+		}
 
-			if (!IsF64Int(mxI->Data[0])) {
-				DIAG_EMIT(DiagIndexNotInteger, node->Identifier.Index->IndexSuffix.I->Loc, DIAG_ARG_NUMBER(mxI->Data[0]));
-				InterpreterPanic();
-			}
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "min", 3) == 0) {
+			return FuncInterpretMin(node);
+		}
 
-			usz i = (usz)mxI->Data[0];
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "max", 3) == 0) {
+			return FuncInterpretMax(node);
+		}
 
-			if (i < 1 || i > var->Shape.Height) {
-				DIAG_EMIT(DiagIndexOutOfRange, node->Identifier.Index->IndexSuffix.I->Loc, DIAG_ARG_NUMBER(mxI->Data[0]),
-					DIAG_ARG_MX_SHAPE(var->Shape));
-				InterpreterPanic();
-			}
+		if (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "norm", 4) == 0) {
+			return FuncInterpretNorm(node);
+		}
 
-			if (node->Identifier.Index->IndexSuffix.J) {
-				Mx* mxJ = InterpreterEval(node->Identifier.Index->IndexSuffix.J);
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "dot", 3) == 0) {
+			return FuncInterpretDot(node);
+		}
 
-				if (!IsF64Int(mxJ->Data[0])) {
-					DIAG_EMIT(DiagIndexNotInteger, node->Identifier.Index->IndexSuffix.J->Loc, DIAG_ARG_NUMBER(mxJ->Data[0]));
-					InterpreterPanic();
-				}
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "any", 3) == 0) {
+			return FuncInterpretAny(node);
+		}
 
-				usz j = (usz)mxJ->Data[0];
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "all", 3) == 0) {
+			return FuncInterpretAll(node);
+		}
 
-				if (j < 1 || j > var->Shape.Width) {
-					DIAG_EMIT(DiagIndexOutOfRange, node->Identifier.Index->IndexSuffix.J->Loc, DIAG_ARG_NUMBER(mxJ->Data[0]),
-						DIAG_ARG_MX_SHAPE(var->Shape));
-					InterpreterPanic();
-				}
+		if (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "where", 5) == 0) {
+			return FuncInterpretWhere(node);
+		}
 
-				Mx* mx = InterpreterAllocMx(1, 1);
-				mx->Data[0] = var->Data[((i - 1) * var->Shape.Width) + j - 1];
-				return mx;
-			}
+		if (node->FnCall.Identifier.SymbolLength == 8 && memcmp(node->FnCall.Identifier.Symbol, "setwhere", 8) == 0) {
+			return FuncInterpretSetWhere(node);
+		}
 
-			Mx* mx = InterpreterAllocMx(1, var->Shape.Width);
-			memcpy(mx->Data, var->Data + ((i - 1) * var->Shape.Width), var->Shape.Width * sizeof(f64));
+		return nullptr;
+	}
+	case ASTNodeIdentifier: {
+		usz id = node->Identifier.ID;
+		Mx* var = g_interpreter.VarTable[id];
+
+		if (node->Identifier.Index) {
+			MxView slice = InterpreterEvalIndexSuffix(ASTNodeGet(node->Identifier.Index), var);
+
+			Mx* mx = InterpreterAllocMx(node, slice.Shape.Height, slice.Shape.Width);
+			MxView out = MxViewOf(mx, 0, 0, mx->Shape);
+
+			MxViewCopy(&slice, &out);
 			return mx;
 		}
 
-		Mx* mx = InterpreterAllocMx(var->Shape.Height, var->Shape.Width);
-		memcpy(mx->Data, var->Data, var->Shape.Height * var->Shape.Width * sizeof(f64));
+		Mx* mx = InterpreterAllocMx(node, var->Shape.Height, var->Shape.Width);
+		MxCopy(var, mx);
 		return mx;
 	}
 	default:
@@ -427,11 +580,32 @@ Mx* InterpreterEval(ASTNode* node)
 	}
 }
 
-void InterpreterInterpret() { InterpreterEval((ASTNode*)g_parser.ASTArena.Blocks->Data); }
+Mx* InterpreterEval(ASTNode* node)
+{
+	// Blocks only hold statements, their own time goes to the line they belong to
+	if (!g_profile.Enabled || node->Type == ASTNodeBlock) {
+		return InterpreterEvalNode(node);
+	}
+
+	ProfileFrame frame = ProfileEnter(node);
+	Mx* mx = InterpreterEvalNode(node);
+	ProfileLeave(node, frame);
+
+	return mx;
+}
+
+void InterpreterInterpret() { InterpreterEval(ASTNodeGet(g_parser.Root)); }
 
 void InterpreterDeinit()
 {
 	free((void*)g_interpreter.VarTable);
 
-	DIAG_PANIC_ON_ERR(DynArenaDeinit(&g_interpreter.MxArena));
+#ifndef _WIN32
+	if (g_interpreter.SlabMappingBytes > 0) {
+		munmap(g_interpreter.SlabMemory, g_interpreter.SlabMappingBytes);
+		return;
+	}
+#endif
+
+	free(g_interpreter.SlabMemory);
 }
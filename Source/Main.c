@@ -1,26 +1,182 @@
+#include "Cache.h"
 #include "Diagnostics.h"
+#include "Estimate.h"
 #include "Interpreter.h"
+#include "MemReport.h"
 #include "Parser.h"
+#include "Planner.h"
+#include "Profile.h"
+#include "Random.h"
 #include "SourceManager.h"
+#include "Stats.h"
 #include "Tokenizer.h"
 #include "TypeChecker.h"
+#include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-int main(int argc, char* argv[])
+// Reads the decimal number `text` starts with, leaving `end` after its last digit
+static bool ParseDecimal(const char* text, unsigned long long* value, char** end)
 {
-	srand((u32)time(0));
+	// strtoull would skip whitespace and negate a leading '-'
+	if (*text < '0' || *text > '9') {
+		return false;
+	}
+
+	errno = 0;
+	*value = strtoull(text, end, 10);
+	return errno != ERANGE;
+}
+
+// Accepts a positive byte count, plain or suffixed with K, M or G. Zero is rejected as it would refuse every program
+static bool ParseByteCount(const char* text, usz* bytes)
+{
+	char* end;
+	unsigned long long count;
+	if (!ParseDecimal(text, &count, &end) || count == 0) {
+		return false;
+	}
+
+	usz shift = 0;
+	switch (*end) {
+	case 'K':
+		shift = 10;
+		break;
+	case 'M':
+		shift = 20;
+		break;
+	case 'G':
+		shift = 30;
+		break;
+	case '\0':
+		break;
+	default:
+		return false;
+	}
 
+	if ((shift > 0 && *++end != '\0') || count > (SIZE_MAX >> shift)) {
+		return false;
+	}
+
+	*bytes = (usz)count << shift;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
 	printf("MxLang v" MX_VERSION "\n\n");
 
-	if (argc < 2) {
+	const char* fileName = nullptr;
+	const char* cacheDir = nullptr;
+	u64 seed = (u64)time(nullptr);
+	bool hugePages = false;
+	bool memReport = false;
+	bool estimate = false;
+	usz maxMemory = 0;
+	bool stats = false;
+	bool statsJson = false;
+	bool profile = false;
+	const char* profileFolded = nullptr;
+	int exitCode = 0;
+	i32 redundantArgs = 0;
+
+	for (i32 i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--seed") == 0) {
+			if (i + 1 >= argc) {
+				fprintf(stderr, "The '--seed' option requires a value\n");
+				return 1;
+			}
+
+			char* end;
+			unsigned long long value;
+			if (!ParseDecimal(argv[++i], &value, &end) || *end != '\0') {
+				fprintf(stderr, "Invalid '--seed' value '%s'\n", argv[i]);
+				return 1;
+			}
+
+			seed = value;
+
+			continue;
+		}
+
+		if (strcmp(argv[i], "--cache") == 0) {
+			if (i + 1 >= argc) {
+				fprintf(stderr, "The '--cache' option requires a directory\n");
+				return 1;
+			}
+
+			cacheDir = argv[++i];
+			continue;
+		}
+
+		if (strcmp(argv[i], "--huge-pages") == 0) {
+			hugePages = true;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--mem-report") == 0) {
+			memReport = true;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--estimate") == 0) {
+			estimate = true;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats-json") == 0) {
+			stats = true;
+			statsJson = strcmp(argv[i], "--stats-json") == 0;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--profile") == 0) {
+			profile = true;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--profile-folded") == 0) {
+			if (i + 1 >= argc) {
+				fprintf(stderr, "The '--profile-folded' option requires a file\n");
+				return 1;
+			}
+
+			profileFolded = argv[++i];
+			continue;
+		}
+
+		if (strcmp(argv[i], "--max-memory") == 0) {
+			if (i + 1 >= argc) {
+				fprintf(stderr, "The '--max-memory' option requires a size\n");
+				return 1;
+			}
+
+			if (!ParseByteCount(argv[++i], &maxMemory)) {
+				fprintf(stderr, "Invalid '--max-memory' value '%s'\n", argv[i]);
+				return 1;
+			}
+
+			continue;
+		}
+
+		if (!fileName) {
+			fileName = argv[i];
+			continue;
+		}
+
+		++redundantArgs;
+	}
+
+	if (!fileName) {
 		fprintf(stderr, "A 'fileName' argument is required\n");
 		return 1;
 	}
 
-	if (argc > 2) {
-		printf("Ignoring redundant arguments. Pwovided %d too many\n", argc - 2);
+	if (redundantArgs > 0) {
+		printf("Ignoring redundant arguments. Pwovided %d too many\n", redundantArgs);
 	}
 
 	if (DiagInit()) {
@@ -28,48 +184,131 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	SourceInit(argv[1]);
+	StatsStart();
 
-	TokenizerInit();
+	SourceInit(fileName);
 
-	ParserInit();
+	StatsLap(StatsPhaseSource);
 
-	ParserParse();
+	bool planned = false;
+	bool cached = cacheDir && CacheLoad(cacheDir);
+	StatsLap(StatsPhaseCache);
 
-	usz errCount = DiagReport();
+	if (!cached) {
+		TokenizerInit();
 
-	TypeCheckerInit();
+		StatsLap(StatsPhaseTokenize);
 
-	TypeCheckerSymbolBind();
+		ParserInit();
 
-	errCount += DiagReport();
+		ParserParse();
 
-	if (errCount <= 0) {
-		TypeCheckerTypeCheck();
+		usz errCount = DiagReport();
+
+		StatsLap(StatsPhaseParse);
+
+		TypeCheckerInit();
+
+		TypeCheckerSymbolBind();
 
 		errCount += DiagReport();
-	} else {
-		fprintf(stderr, "Error(s) emitted. Stopping now\n");
-		goto deinit;
+
+		StatsLap(StatsPhaseBind);
+
+		if (errCount <= 0) {
+			TypeCheckerTypeCheck();
+
+			errCount += DiagReport();
+
+			StatsLap(StatsPhaseTypeCheck);
+		}
+
+		if (errCount > 0) {
+			fprintf(stderr, "Error(s) emitted. Stopping now\n");
+			goto deinit;
+		}
+
+		if (cacheDir) {
+			CacheStore(cacheDir);
+
+			StatsLap(StatsPhaseCache);
+		}
 	}
 
-	if (errCount <= 0) {
-		InterpreterInit();
+	RandomInit(seed);
+
+	PlannerPlan();
+	planned = true;
+
+	StatsLap(StatsPhasePlan);
+
+	if (estimate) {
+		EstimateCompute();
+
+		EstimatePrint();
+
+		EstimateDeinit();
+
+		StatsLap(StatsPhaseEstimate);
+	}
+
+	// Rejected before anything runs, the slab is all the matrix memory the program will ever use
+	if (maxMemory > 0 && g_planner.SlabBytes > maxMemory) {
+		fprintf(stderr, "The program needs %zu bytes of matrix memory, more than the %zu allowed by '--max-memory'\n", g_planner.SlabBytes,
+			maxMemory);
+		exitCode = 1;
+	} else if (!estimate) {
+		InterpreterInit(hugePages);
+
+		if (memReport) {
+			MemReportInstall();
+		}
+
+		if (profile || profileFolded) {
+			ProfileInit();
+		}
 
 		InterpreterInterpret();
 
-		InterpreterDeinit();
-	} else {
-		fprintf(stderr, "Error(s) emitted. Stopping now\n");
-		goto deinit;
+		StatsLap(StatsPhaseInterpret);
+
+		if (profile) {
+			ProfilePrint();
+		}
+
+		if (profileFolded && !ProfileWriteFolded(profileFolded)) {
+			fprintf(stderr, "Could not write the folded profile to '%s'\n", profileFolded);
+			exitCode = 1;
+		}
+
+		ProfileDeinit();
+
+		if (memReport) {
+			MemReportPrint();
+		}
 	}
 
 deinit:
-	TypeCheckerDeinit();
+	// Printed before anything gets freed, a program stopped by compile errors still shows how far it got
+	if (stats) {
+		StatsPrint(statsJson);
+	}
+
+	if (planned) {
+		InterpreterDeinit();
+
+		PlannerDeinit();
+	}
+
+	if (cached) {
+		CacheDeinit();
+	} else {
+		TypeCheckerDeinit();
 
-	ParserDeinit();
+		ParserDeinit();
 
-	TokenizerDeinit();
+		TokenizerDeinit();
+	}
 
 	SourceDeinit();
 
@@ -78,5 +317,5 @@ deinit:
 		return 1;
 	}
 
-	return 0;
+	return exitCode;
 }
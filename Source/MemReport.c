@@ -0,0 +1,170 @@
+#include "MemReport.h"
+
+#include "Cache.h"
+#include "Diagnostics.h"
+#include "Interpreter.h"
+#include "Parser.h"
+#include "Planner.h"
+#include "SourceManager.h"
+#include "Tokenizer.h"
+#include "TypeChecker.h"
+#include <stdio.h>
+
+volatile sig_atomic_t g_memReportPending = 0;
+
+// A single allocation made without a container keeping count
+static MemStats MemReportFixed(usz bytes)
+{
+	return (MemStats) { bytes, bytes, bytes > 0 ? 1 : 0, bytes, bytes };
+}
+
+static void MemReportAdd(MemStats* total, MemStats stats)
+{
+	total->RequestedBytes += stats.RequestedBytes;
+	total->ReservedBytes += stats.ReservedBytes;
+	total->BlockCount += stats.BlockCount;
+	total->PeakRequestedBytes += stats.PeakRequestedBytes;
+	total->PeakReservedBytes += stats.PeakReservedBytes;
+}
+
+static void MemReportRow(const char* name, MemStats stats)
+{
+	fprintf(stderr, "  %-18s %14zu %14zu %8zu %14zu %14zu\n", name, stats.RequestedBytes, stats.ReservedBytes, stats.BlockCount,
+		stats.PeakRequestedBytes, stats.PeakReservedBytes);
+}
+
+// The planner decides where matrices go, the slab is only as big as the most that is ever live at once
+static MemStats MemReportSlab()
+{
+	usz reserved = g_interpreter.SlabMappingBytes > 0 ? g_interpreter.SlabMappingBytes : g_planner.SlabBytes + PLANNER_ALIGNMENT - 1;
+	if (!g_interpreter.SlabMemory) {
+		reserved = 0;
+	}
+
+	return (MemStats) { g_planner.SlabBytes, reserved, reserved > 0 ? 1 : 0, g_planner.SlabBytes, reserved };
+}
+
+// A variable holds its matrix for as long as its slot points at the place its declaration got. A variable of a block that
+// already ended keeps showing up until its slot gets taken over
+static void MemReportVariables()
+{
+	if (!g_interpreter.VarTable || !g_interpreter.Slab) {
+		return;
+	}
+
+	fprintf(stderr, "Variables\n");
+	fprintf(stderr, "  %-18s %14s %14s\n", "Name", "Shape", "Bytes");
+
+	usz totalBytes = 0;
+	for (usz i = 0; i < g_parser.Nodes.Count; ++i) {
+		ASTNode* node = DynArrayAt(&g_parser.Nodes, i);
+		if (node->Type != ASTNodeVarDecl) {
+			continue;
+		}
+
+		if ((u8*)g_interpreter.VarTable[node->VarDecl.ID] != g_interpreter.Slab + g_planner.Offsets[ASTNodeIDOf(node)]) {
+			continue;
+		}
+
+		char shape[48];
+		snprintf(shape, sizeof(shape), "%zux%zu", node->VarDecl.Shape.Height, node->VarDecl.Shape.Width);
+
+		usz bytes = PlannerMxBytes(node->VarDecl.Shape);
+		totalBytes += bytes;
+
+		fprintf(stderr, "  %-18.*s %14s %14zu\n", (i32)node->VarDecl.Identifier.SymbolLength, node->VarDecl.Identifier.Symbol, shape,
+			bytes);
+	}
+
+	fprintf(stderr, "  %-18s %14s %14zu\n", "Total", "", totalBytes);
+}
+
+static void MemReportPush(MemReportEntry* entries, usz* count, const char* name, MemStats stats)
+{
+	entries[(*count)++] = (MemReportEntry) { name, stats };
+}
+
+usz MemReportCollect(MemReportEntry entries[MEM_REPORT_MAX_ENTRIES])
+{
+	usz count = 0;
+
+	MemReportPush(entries, &count, "source", MemReportFixed(g_source.SourceLength));
+	MemReportPush(entries, &count, "source lines", MemReportFixed(g_source.Lines ? g_source.LineCount * sizeof(const char*) : 0));
+
+	// A cached program is one mapping, the front end never ran
+	if (g_cache.Mapping) {
+		MemReportPush(entries, &count, "cache", MemReportFixed(g_cache.MappingLength));
+	} else {
+		usz tokenBytes = sizeof(TokenType) + sizeof(TokenValue) + sizeof(SourceLoc);
+		MemStats tokens = MemReportFixed(g_tokenizer.Tokens.Capacity * tokenBytes);
+		tokens.RequestedBytes = g_tokenizer.Tokens.Count * tokenBytes;
+		tokens.PeakRequestedBytes = tokens.RequestedBytes;
+		tokens.BlockCount *= 3;
+
+		MemReportPush(entries, &count, "tokens", tokens);
+		MemReportPush(entries, &count, "identifiers", SymbolTableStats(&g_tokenizer.TableIdentifiers));
+		MemReportPush(entries, &count, "nodes", DynArrayStats(&g_parser.Nodes));
+		MemReportPush(entries, &count, "children", DynArrayStats(&g_parser.Children));
+		MemReportPush(entries, &count, "numbers", DynArrayStats(&g_parser.Numbers));
+		MemReportPush(entries, &count, "parser scratch", DynArrayStats(&g_parser.NodeScratch));
+		MemReportPush(entries, &count, "width scratch", DynArrayStats(&g_parser.WidthScratch));
+		MemReportPush(entries, &count, "bindings", DynArrayStats(&g_typeChecker.Bindings));
+		MemReportPush(entries, &count, "binding scopes", DynArrayStats(&g_typeChecker.BindingScopes));
+
+		usz typeBytes = g_typeChecker.TypeCheckingTable ? g_typeChecker.VarSlotCount * sizeof(TypeCheckingEntry) : 0;
+		MemReportPush(entries, &count, "variable types", MemReportFixed(typeBytes));
+
+		usz shapeBytes = g_typeChecker.NodeShapes ? g_parser.Nodes.Count * sizeof(MxShape) : 0;
+		MemReportPush(entries, &count, "node shapes", MemReportFixed(shapeBytes));
+	}
+
+	MemReportPush(entries, &count, "diagnostics", g_diagState.Arena.Stats);
+
+	usz planBytes = g_planner.Offsets ? g_parser.Nodes.Count * (sizeof(usz) + sizeof(bool)) : 0;
+	MemReportPush(entries, &count, "plan offsets", MemReportFixed(planBytes));
+	MemReportPush(entries, &count, "plan free ranges", DynArrayStats(&g_planner.FreeRanges));
+	MemReportPush(entries, &count, "plan live ranges", DynArrayStats(&g_planner.LiveRanges));
+	MemReportPush(entries, &count, "matrix slab", MemReportSlab());
+	MemReportPush(entries, &count, "variable slots", MemReportFixed(g_interpreter.VarTable ? g_typeChecker.VarSlotCount * sizeof(Mx*) : 0));
+
+	return count;
+}
+
+void MemReportPrint()
+{
+	g_memReportPending = 0;
+
+	MemReportEntry entries[MEM_REPORT_MAX_ENTRIES];
+	usz entryCount = MemReportCollect(entries);
+
+	fprintf(stderr, "Memory report\n");
+	fprintf(stderr, "  %-18s %14s %14s %8s %14s %14s\n", "Container", "Requested", "Reserved", "Blocks", "Peak requested",
+		"Peak reserved");
+
+	MemStats total = { 0 };
+	for (usz i = 0; i < entryCount; ++i) {
+		MemReportRow(entries[i].Name, entries[i].Stats);
+		MemReportAdd(&total, entries[i].Stats);
+	}
+
+	MemReportRow("Total", total);
+
+	MemReportVariables();
+
+	fflush(stderr);
+}
+
+#ifndef _WIN32
+static void MemReportOnSignal(int signalNumber)
+{
+	(void)signalNumber;
+	g_memReportPending = 1;
+}
+#endif
+
+void MemReportInstall()
+{
+#ifndef _WIN32
+	signal(SIGUSR1, MemReportOnSignal);
+#endif
+}
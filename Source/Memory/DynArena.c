@@ -4,9 +4,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-static Result DynArenaBlockNew(DynArenaBlock** block)
+static Result DynArenaBlockNew(DynArena* arena, DynArenaBlock** block, usz capacityBytes)
 {
-	usz blockSize = sizeof(DynArenaBlock) + DYN_ARENA_BLOCK_DEFAULT_CAPACITY;
+	usz blockSize = sizeof(DynArenaBlock) + capacityBytes;
 
 	*block = malloc(blockSize);
 
@@ -14,8 +14,10 @@ static Result DynArenaBlockNew(DynArenaBlock** block)
 		return ResOutOfMemory;
 	}
 
+	MemStatsReserve(&arena->Stats, blockSize);
+
 	(*block)->NextBlock = nullptr;
-	(*block)->CapacityBytes = DYN_ARENA_BLOCK_DEFAULT_CAPACITY;
+	(*block)->CapacityBytes = capacityBytes;
 	(*block)->NextBytes = (*block)->Data;
 
 	// printf("New block! capacity = %lu addr = %p\n", (*block)->CapacityBytes, (void*)*block);
@@ -23,7 +25,7 @@ static Result DynArenaBlockNew(DynArenaBlock** block)
 	return ResOk;
 }
 
-static void DynArenaBlockFreeChain(DynArenaBlock* block)
+static void DynArenaBlockFreeChain(DynArena* arena, DynArenaBlock* block)
 {
 	if (!block) {
 		printf("Warn: Attempted to free a 'nullptr' block chain!\n");
@@ -31,6 +33,8 @@ static void DynArenaBlockFreeChain(DynArenaBlock* block)
 
 	while (block) {
 		DynArenaBlock* next = block->NextBlock;
+		arena->Stats.RequestedBytes -= (usz)(block->NextBytes - block->Data);
+		MemStatsRelease(&arena->Stats, sizeof(DynArenaBlock) + block->CapacityBytes);
 		free(block);
 		// printf("Freed block! addr = %p\n", (void*)block);
 		block = next;
@@ -43,7 +47,16 @@ Result DynArenaInit(DynArena* arena)
 		return ResInvalidParams;
 	}
 
-	return DynArenaBlockNew(&arena->Blocks);
+	arena->Stats = (MemStats) { 0 };
+
+	Result result = DynArenaBlockNew(arena, &arena->Blocks, DYN_ARENA_BLOCK_DEFAULT_CAPACITY);
+	if (result) {
+		return result;
+	}
+
+	arena->Tail = arena->Blocks;
+
+	return ResOk;
 }
 
 Result DynArenaMarkSet(DynArena* arena, DynArenaMark* mark)
@@ -52,19 +65,16 @@ Result DynArenaMarkSet(DynArena* arena, DynArenaMark* mark)
 		return ResInvalidParams;
 	}
 
-	DynArenaBlock* tail = arena->Blocks;
-	// An arena will always have at least one block with free memory available, so this is safe
-	while (tail->NextBlock) {
-		tail = tail->NextBlock;
-	}
+	DynArenaBlock* tail = arena->Tail;
 
 	if (tail->NextBytes >= tail->Data + tail->CapacityBytes) {
-		Result result = DynArenaBlockNew(&tail->NextBlock);
+		Result result = DynArenaBlockNew(arena, &tail->NextBlock, DYN_ARENA_BLOCK_DEFAULT_CAPACITY);
 		if (result) {
 			return result;
 		}
 
 		tail = tail->NextBlock;
+		arena->Tail = tail;
 	}
 
 	mark->Blocks = tail;
@@ -82,11 +92,13 @@ Result DynArenaMarkUndo(DynArena* arena, DynArenaMark* mark)
 	}
 
 	if (mark->Blocks->NextBlock) {
-		DynArenaBlockFreeChain(mark->Blocks->NextBlock);
+		DynArenaBlockFreeChain(arena, mark->Blocks->NextBlock);
 		mark->Blocks->NextBlock = nullptr;
 	}
 
+	arena->Stats.RequestedBytes -= (usz)(mark->Blocks->NextBytes - mark->ByteMark);
 	mark->Blocks->NextBytes = mark->ByteMark;
+	arena->Tail = mark->Blocks;
 
 	// printf("Mark undid! new arena tail = %p, bytes next = %p\n", (void*)mark->Blocks, mark->Blocks->NextBytes);
 
@@ -99,11 +111,9 @@ Result DynArenaAlloc(DynArena* arena, void** buffer, usz size)
 		return ResInvalidParams;
 	}
 
-	DynArenaBlock* tail = arena->Blocks;
-	// An arena will always have at least one block with free memory available, so this is safe
-	while (tail->NextBlock) {
-		tail = tail->NextBlock;
-	}
+	DynArenaBlock* tail = arena->Tail;
+
+	MemStatsRequest(&arena->Stats, size);
 
 	if (tail->NextBytes + size <= tail->Data + tail->CapacityBytes) {
 		*buffer = tail->NextBytes;
@@ -113,17 +123,15 @@ Result DynArenaAlloc(DynArena* arena, void** buffer, usz size)
 		return ResOk;
 	}
 
-	// TODO: Check if allocation size exceeds block size, then do something
-	if (size > DYN_ARENA_BLOCK_DEFAULT_CAPACITY) {
-		return ResUnimplemented;
-	}
-
-	Result result = DynArenaBlockNew(&tail->NextBlock);
+	// Allocations bigger than the default capacity get a block of their own
+	usz capacity = size > DYN_ARENA_BLOCK_DEFAULT_CAPACITY ? size : DYN_ARENA_BLOCK_DEFAULT_CAPACITY;
+	Result result = DynArenaBlockNew(arena, &tail->NextBlock, capacity);
 	if (result) {
 		return result;
 	}
 
 	tail = tail->NextBlock;
+	arena->Tail = tail;
 	*buffer = tail->NextBytes;
 	tail->NextBytes += size;
 	// printf("Allocation! next bytes = %p, from block = %p\n", tail->NextBytes, (void*)tail);
@@ -148,9 +156,10 @@ Result DynArenaDeinit(DynArena* arena)
 		return ResInvalidParams;
 	}
 
-	DynArenaBlockFreeChain(arena->Blocks);
+	DynArenaBlockFreeChain(arena, arena->Blocks);
 
 	arena->Blocks = nullptr;
+	arena->Tail = nullptr;
 
 	return ResOk;
 }
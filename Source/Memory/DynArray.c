@@ -0,0 +1,73 @@
+#include "Memory/DynArray.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr usz DYN_ARRAY_DEFAULT_CAPACITY = 64;
+
+Result DynArrayInit(DynArray* array, usz itemSizeBytes)
+{
+	if (!array || itemSizeBytes <= 0) {
+		return ResInvalidParams;
+	}
+
+	array->Items = malloc(DYN_ARRAY_DEFAULT_CAPACITY * itemSizeBytes);
+	if (!array->Items) {
+		return ResOutOfMemory;
+	}
+
+	array->Count = 0;
+	array->Capacity = DYN_ARRAY_DEFAULT_CAPACITY;
+	array->ItemSizeBytes = itemSizeBytes;
+
+	return ResOk;
+}
+
+Result DynArrayPush(DynArray* array, const void* item)
+{
+	if (!array || !item) {
+		return ResInvalidParams;
+	}
+
+	if (array->Count >= array->Capacity) {
+		u8* newItems = realloc(array->Items, array->Capacity * 2 * array->ItemSizeBytes);
+		if (!newItems) {
+			return ResOutOfMemory;
+		}
+
+		array->Items = newItems;
+		array->Capacity *= 2;
+	}
+
+	memcpy(array->Items + (array->Count * array->ItemSizeBytes), item, array->ItemSizeBytes);
+	++array->Count;
+
+	return ResOk;
+}
+
+void* DynArrayAt(DynArray* array, usz index) { return array->Items + (index * array->ItemSizeBytes); }
+
+Result DynArrayTruncate(DynArray* array, usz count)
+{
+	if (!array || count > array->Count) {
+		return ResInvalidParams;
+	}
+
+	array->Count = count;
+
+	return ResOk;
+}
+
+Result DynArrayDeinit(DynArray* array)
+{
+	if (!array) {
+		return ResInvalidParams;
+	}
+
+	free(array->Items);
+	array->Items = nullptr;
+	array->Count = 0;
+	array->Capacity = 0;
+
+	return ResOk;
+}
@@ -4,9 +4,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-static Result StatArenaBlockNew(StatArenaBlock** block, usz itemSizeBytes)
+static Result StatArenaBlockNew(StatArena* arena, StatArenaBlock** block)
 {
-	usz capacityBytes = itemSizeBytes * 64;
+	usz capacityBytes = arena->ItemSizeBytes * 64;
 	usz blockSizeBytes = sizeof(StatArenaBlock) + capacityBytes;
 
 	*block = malloc(blockSizeBytes);
@@ -15,6 +15,8 @@ static Result StatArenaBlockNew(StatArenaBlock** block, usz itemSizeBytes)
 		return ResOutOfMemory;
 	}
 
+	MemStatsReserve(&arena->Stats, blockSizeBytes);
+
 	(*block)->NextBlock = nullptr;
 	(*block)->PrevBlock = nullptr;
 	(*block)->CapacityBytes = capacityBytes;
@@ -25,7 +27,7 @@ static Result StatArenaBlockNew(StatArenaBlock** block, usz itemSizeBytes)
 	return ResOk;
 }
 
-static void StatArenaBlockFreeChain(StatArenaBlock* block)
+static void StatArenaBlockFreeChain(StatArena* arena, StatArenaBlock* block)
 {
 	if (!block) {
 		printf("Warn: Attempted to free a 'nullptr' block chain!\n");
@@ -33,6 +35,8 @@ static void StatArenaBlockFreeChain(StatArenaBlock* block)
 
 	while (block) {
 		StatArenaBlock* next = block->NextBlock;
+		arena->Stats.RequestedBytes -= (usz)(block->NextBytes - block->Data);
+		MemStatsRelease(&arena->Stats, sizeof(StatArenaBlock) + block->CapacityBytes);
 		free(block);
 		// printf("Freed block! addr = %p\n", (void*)block);
 		block = next;
@@ -46,8 +50,9 @@ Result StatArenaInit(StatArena* arena, usz itemSizeBytes)
 	}
 
 	arena->ItemSizeBytes = itemSizeBytes;
+	arena->Stats = (MemStats) { 0 };
 
-	return StatArenaBlockNew(&arena->Blocks, arena->ItemSizeBytes);
+	return StatArenaBlockNew(arena, &arena->Blocks);
 }
 
 Result StatArenaMarkSet(StatArena* arena, StatArenaMark* mark)
@@ -63,7 +68,7 @@ Result StatArenaMarkSet(StatArena* arena, StatArenaMark* mark)
 	}
 
 	if (tail->NextBytes >= tail->Data + tail->CapacityBytes) {
-		Result result = StatArenaBlockNew(&tail->NextBlock, arena->ItemSizeBytes);
+		Result result = StatArenaBlockNew(arena, &tail->NextBlock);
 		if (result) {
 			return result;
 		}
@@ -86,10 +91,11 @@ Result StatArenaMarkUndo(StatArena* arena, StatArenaMark* mark)
 	}
 
 	if (mark->Blocks->NextBlock) {
-		StatArenaBlockFreeChain(mark->Blocks->NextBlock);
+		StatArenaBlockFreeChain(arena, mark->Blocks->NextBlock);
 		mark->Blocks->NextBlock = nullptr;
 	}
 
+	arena->Stats.RequestedBytes -= (usz)(mark->Blocks->NextBytes - mark->ByteMark);
 	mark->Blocks->NextBytes = mark->ByteMark;
 
 	// printf("Mark undid! new arena tail = %p, bytes next = %p\n", (void*)mark->Blocks, mark->Blocks->NextBytes);
@@ -109,6 +115,8 @@ Result StatArenaAlloc(StatArena* arena, void** buffer)
 		tail = tail->NextBlock;
 	}
 
+	MemStatsRequest(&arena->Stats, arena->ItemSizeBytes);
+
 	if (tail->NextBytes + arena->ItemSizeBytes <= tail->Data + tail->CapacityBytes) {
 		*buffer = tail->NextBytes;
 		tail->NextBytes += arena->ItemSizeBytes;
@@ -117,7 +125,7 @@ Result StatArenaAlloc(StatArena* arena, void** buffer)
 		return ResOk;
 	}
 
-	Result result = StatArenaBlockNew(&tail->NextBlock, arena->ItemSizeBytes);
+	Result result = StatArenaBlockNew(arena, &tail->NextBlock);
 	if (result) {
 		return result;
 	}
@@ -194,7 +202,7 @@ Result StatArenaDeinit(StatArena* arena)
 		return ResInvalidParams;
 	}
 
-	StatArenaBlockFreeChain(arena->Blocks);
+	StatArenaBlockFreeChain(arena, arena->Blocks);
 
 	arena->Blocks = nullptr;
 
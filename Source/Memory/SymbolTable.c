@@ -1,20 +1,176 @@
 #include "Memory/SymbolTable.h"
 
+#include "Simd.h"
 #include <stdlib.h>
 #include <string.h>
 
-// FNV-1a
-// TODO: Consider robin hood hashing
-static u64 HashString(const char* str, usz strLength)
+static constexpr usz SYMBOL_TABLE_GROUP_WIDTH = 16;
+static constexpr usz SYMBOL_TABLE_DEFAULT_CAPACITY = 128;
+static constexpr u8 SYMBOL_TABLE_CONTROL_EMPTY = 0x80;
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 u128;
+#endif
+
+static inline void HashMultiply(u64* a, u64* b)
+{
+#if defined(__SIZEOF_INT128__)
+	u128 product = (u128)*a * *b;
+	*a = (u64)product;
+	*b = (u64)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	*a = _umul128(*a, *b, b);
+#else
+	u64 highA = *a >> 32;
+	u64 highB = *b >> 32;
+	u64 lowA = (u32)*a;
+	u64 lowB = (u32)*b;
+
+	u64 high = highA * highB;
+	u64 middle0 = highA * lowB;
+	u64 middle1 = highB * lowA;
+	u64 low = lowA * lowB;
+
+	u64 t = low + (middle0 << 32);
+	u64 carry = t < low;
+	u64 result = t + (middle1 << 32);
+	carry += result < t;
+
+	*a = result;
+	*b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+}
+
+static inline u64 HashMix(u64 a, u64 b)
+{
+	HashMultiply(&a, &b);
+	return a ^ b;
+}
+
+static inline u64 HashRead8(const u8* bytes)
+{
+	u64 value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static inline u64 HashRead4(const u8* bytes)
+{
+	u32 value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static const u64 g_hashSecret[4] = { 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
+// wyhash, consumes the key a word at a time instead of a byte at a time
+u64 SymbolHash(const char* key, usz keyLength)
+{
+	const u8* bytes = (const u8*)key;
+	u64 seed = HashMix(g_hashSecret[0], g_hashSecret[1]);
+	u64 a;
+	u64 b;
+
+	if (keyLength <= 16) {
+		if (keyLength >= 4) {
+			usz offset = (keyLength >> 3) << 2;
+			a = (HashRead4(bytes) << 32) | HashRead4(bytes + offset);
+			b = (HashRead4(bytes + keyLength - 4) << 32) | HashRead4(bytes + keyLength - 4 - offset);
+		} else if (keyLength > 0) {
+			a = ((u64)bytes[0] << 16) | ((u64)bytes[keyLength >> 1] << 8) | bytes[keyLength - 1];
+			b = 0;
+		} else {
+			a = 0;
+			b = 0;
+		}
+	} else {
+		usz remaining = keyLength;
+		while (remaining > 16) {
+			seed = HashMix(HashRead8(bytes) ^ g_hashSecret[1], HashRead8(bytes + 8) ^ seed);
+			bytes += 16;
+			remaining -= 16;
+		}
+
+		a = HashRead8(bytes + remaining - 16);
+		b = HashRead8(bytes + remaining - 8);
+	}
+
+	a ^= g_hashSecret[1];
+	b ^= seed;
+	HashMultiply(&a, &b);
+
+	return HashMix(a ^ g_hashSecret[0] ^ keyLength, b ^ g_hashSecret[1]);
+}
+
+static inline u8 ControlOf(u64 hash) { return (u8)(hash & 0x7F); }
+
+// Bit i is set when the i-th control byte of the group equals `control`
+static inline u32 GroupMatch(const u8* group, u8 control)
+{
+#ifdef MX_SSE2
+	__m128i controls = _mm_loadu_si128((const __m128i*)(const void*)group);
+	return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8((char)control)));
+#else
+	u32 mask = 0;
+	for (usz i = 0; i < SYMBOL_TABLE_GROUP_WIDTH; ++i) {
+		mask |= (u32)(group[i] == control) << i;
+	}
+
+	return mask;
+#endif
+}
+
+// Finds the entry for the key, or the empty slot it would go into
+static usz SymbolTableProbe(const SymbolTable* table, const char* key, usz keyLength, u64 hash, bool* found)
+{
+	usz groupMask = table->Capacity / SYMBOL_TABLE_GROUP_WIDTH - 1;
+	usz group = (usz)(hash >> 7) & groupMask;
+	u8 control = ControlOf(hash);
+
+	// Triangular steps visit every group once the group count is a power of two
+	for (usz step = 1;; ++step) {
+		const u8* controls = table->Controls + group * SYMBOL_TABLE_GROUP_WIDTH;
+
+		for (u32 matches = GroupMatch(controls, control); matches; matches &= matches - 1) {
+			usz slot = group * SYMBOL_TABLE_GROUP_WIDTH + CountTrailingZeros(matches);
+			SymbolTableEntry* entry = table->Entries[slot];
+
+			if (entry->Hash == hash && entry->KeyLength == keyLength && memcmp(entry->Key, key, keyLength) == 0) {
+				*found = true;
+				return slot;
+			}
+		}
+
+		u32 empty = GroupMatch(controls, SYMBOL_TABLE_CONTROL_EMPTY);
+		if (empty) {
+			*found = false;
+			return group * SYMBOL_TABLE_GROUP_WIDTH + CountTrailingZeros(empty);
+		}
+
+		group = (group + step) & groupMask;
+	}
+}
+
+static Result SymbolTableAllocSlots(SymbolTable* table, usz capacity)
 {
-	u64 hash = 14695981039346656037UL;
+	u8* controls = (u8*)malloc(capacity);
+	if (!controls) {
+		return ResOutOfMemory;
+	}
 
-	for (usz i = 0; i < strLength; ++i) {
-		hash ^= (u64)(u8)str[i];
-		hash *= 1099511628211UL;
+	SymbolTableEntry** entries = (SymbolTableEntry**)malloc(capacity * sizeof(SymbolTableEntry*));
+	if (!entries) {
+		free((void*)controls);
+		return ResOutOfMemory;
 	}
 
-	return hash;
+	memset(controls, SYMBOL_TABLE_CONTROL_EMPTY, capacity);
+
+	table->Controls = controls;
+	table->Entries = entries;
+	table->Capacity = capacity;
+
+	return ResOk;
 }
 
 static Result SymbolTableExpand(SymbolTable* table)
@@ -23,29 +179,31 @@ static Result SymbolTableExpand(SymbolTable* table)
 		return ResInvalidParams;
 	}
 
+	u8* oldControls = table->Controls;
+	SymbolTableEntry** oldEntries = table->Entries;
 	usz oldCapacity = table->Capacity;
-	table->Capacity *= 2;
-	SymbolTableEntry** newEntries = (SymbolTableEntry**)calloc(table->Capacity, sizeof(SymbolTableEntry*));
-	if (!newEntries) {
-		return ResOutOfMemory;
+
+	Result result = SymbolTableAllocSlots(table, oldCapacity * 2);
+	if (result) {
+		return result;
 	}
 
+	// Entries keep their hash so growing never touches the keys
 	for (usz i = 0; i < oldCapacity; ++i) {
-		SymbolTableEntry* entry = table->Entries[i];
-		if (!entry) {
+		if (oldControls[i] == SYMBOL_TABLE_CONTROL_EMPTY) {
 			continue;
 		}
 
-		usz destIndex = entry->Hash & (table->Capacity - 1);
+		SymbolTableEntry* entry = oldEntries[i];
+		bool found;
+		usz slot = SymbolTableProbe(table, entry->Key, entry->KeyLength, entry->Hash, &found);
 
-		while (newEntries[destIndex]) {
-			destIndex = (destIndex + 1) & (table->Capacity - 1);
-		}
-		newEntries[destIndex] = entry;
+		table->Controls[slot] = oldControls[i];
+		table->Entries[slot] = entry;
 	}
 
-	free((void*)table->Entries);
-	table->Entries = newEntries;
+	free((void*)oldEntries);
+	free((void*)oldControls);
 
 	return ResOk;
 }
@@ -61,64 +219,44 @@ Result SymbolTableInit(SymbolTable* table)
 		return result;
 	}
 
-	table->Capacity = 128;
 	table->EntryCount = 0;
 
-	table->Entries = (SymbolTableEntry**)calloc(table->Capacity, sizeof(SymbolTableEntry*));
-	if (!table->Entries) {
-		return ResOutOfMemory;
-	}
-
-	return ResOk;
+	return SymbolTableAllocSlots(table, SYMBOL_TABLE_DEFAULT_CAPACITY);
 }
 
-Result SymbolTableContains(SymbolTable* table, const char* key, usz keyLength)
+Result SymbolTableContains(SymbolTable* table, const char* key, usz keyLength, u64 hash)
 {
 	if (!table || !key || keyLength <= 0) {
 		return ResInvalidParams;
 	}
 
-	u64 hash = HashString(key, keyLength);
-	u64 i = hash & (table->Capacity - 1);
-
-	while (table->Entries[i]) {
-		if (table->Entries[i]->Hash == hash && keyLength == table->Entries[i]->KeyLength
-			&& memcmp(key, table->Entries[i]->Key, table->Entries[i]->KeyLength) == 0) {
-			return ResOk;
-		}
-
-		i = (i + 1) & (table->Capacity - 1);
-	}
+	bool found;
+	SymbolTableProbe(table, key, keyLength, hash, &found);
 
-	return ResNotFound;
+	return found ? ResOk : ResNotFound;
 }
 
-Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, SymbolView* internedSymbol)
+Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, u64 hash, SymbolView* internedSymbol)
 {
 	if (!table || !key || keyLength <= 0) {
 		return ResInvalidParams;
 	}
 
-	// We expand the table when we filled it up to 75%
-	if ((table->EntryCount + 1) * 100 / table->Capacity > 75) {
+	// We expand the table when we filled it up to 7/8, group probing stays short well past the 75% linear probing needed
+	if ((table->EntryCount + 1) * 8 > table->Capacity * 7) {
 		Result result = SymbolTableExpand(table);
 		if (result) {
 			return result;
 		}
 	}
 
-	u64 hash = HashString(key, keyLength);
-	usz i = hash & (table->Capacity - 1);
+	bool found;
+	usz slot = SymbolTableProbe(table, key, keyLength, hash, &found);
 
-	while (table->Entries[i]) {
-		if (table->Entries[i]->Hash == hash && keyLength == table->Entries[i]->KeyLength
-			&& memcmp(key, table->Entries[i]->Key, table->Entries[i]->KeyLength) == 0) {
-			internedSymbol->Symbol = table->Entries[i]->Key;
-			internedSymbol->SymbolLength = table->Entries[i]->KeyLength;
-			return ResOk;
-		}
-
-		i = (i + 1) & (table->Capacity - 1);
+	if (found) {
+		internedSymbol->Symbol = table->Entries[slot]->Key;
+		internedSymbol->SymbolLength = table->Entries[slot]->KeyLength;
+		return ResOk;
 	}
 
 	SymbolTableEntry* newEntry;
@@ -129,8 +267,11 @@ Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, Symbol
 
 	newEntry->Hash = hash;
 	newEntry->KeyLength = keyLength;
+	newEntry->Binding = 0;
 	memcpy(newEntry->Key, key, keyLength);
-	table->Entries[i] = newEntry;
+
+	table->Controls[slot] = ControlOf(hash);
+	table->Entries[slot] = newEntry;
 
 	++table->EntryCount;
 
@@ -140,6 +281,21 @@ Result SymbolTableAdd(SymbolTable* table, const char* key, usz keyLength, Symbol
 	return ResOk;
 }
 
+MemStats SymbolTableStats(const SymbolTable* table)
+{
+	usz slotBytes = sizeof(u8) + sizeof(SymbolTableEntry*);
+
+	MemStats stats = table->Arena.Stats;
+	if (table->Capacity > 0) {
+		MemStatsRequest(&stats, table->EntryCount * slotBytes);
+		MemStatsReserve(&stats, table->Capacity * slotBytes);
+		// The controls and the entries are separate allocations
+		++stats.BlockCount;
+	}
+
+	return stats;
+}
+
 Result SymbolTableDeinit(SymbolTable* table)
 {
 	if (!table) {
@@ -147,6 +303,7 @@ Result SymbolTableDeinit(SymbolTable* table)
 	}
 
 	free((void*)table->Entries);
+	free((void*)table->Controls);
 	table->Capacity = 0;
 	table->EntryCount = 0;
 
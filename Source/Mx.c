@@ -1,5 +1,4 @@
 #include "Mx.h"
-#include "Interpreter.h"
 
 #include <math.h>
 #include <stdio.h>
@@ -16,6 +15,33 @@ bool IsF64Int(f64 num)
 	return trunc(num) == num;
 }
 
+MxView MxViewOf(Mx* mx, usz row, usz col, MxShape shape)
+{
+	MxView view = { .Shape = shape, .Stride = mx->Stride, .Data = mx->Data + (row * mx->Stride) + col };
+	return view;
+}
+
+void MxViewCopy(const MxView* src, const MxView* dst)
+{
+	// Both views are contiguous, so this is a single copy
+	if (src->Stride == src->Shape.Width && dst->Stride == dst->Shape.Width) {
+		memcpy(dst->Data, src->Data, src->Shape.Height * src->Shape.Width * sizeof(f64));
+		return;
+	}
+
+	for (usz i = 0; i < src->Shape.Height; ++i) {
+		memcpy(dst->Data + (i * dst->Stride), src->Data + (i * src->Stride), src->Shape.Width * sizeof(f64));
+	}
+}
+
+void MxCopy(const Mx* src, Mx* dst)
+{
+	MxView from = MxViewOf((Mx*)src, 0, 0, src->Shape);
+	MxView to = MxViewOf(dst, 0, 0, dst->Shape);
+
+	MxViewCopy(&from, &to);
+}
+
 void MxPrint(const Mx* mx)
 {
 	if (mx->Shape.Height == 1 && mx->Shape.Width == 1) {
@@ -27,7 +53,7 @@ void MxPrint(const Mx* mx)
 		printf("[");
 
 		for (usz j = 0; j < mx->Shape.Width; ++j) {
-			printf("%lf", mx->Data[(i * mx->Shape.Width) + j]);
+			printf("%lf", mx->Data[(i * mx->Stride) + j]);
 
 			if (j < mx->Shape.Width - 1) {
 				printf(" ");
@@ -38,63 +64,170 @@ void MxPrint(const Mx* mx)
 	}
 }
 
-void MxAdd(const Mx* left, const Mx* right, Mx* out)
+// Two shapes are broadcastable when each of their dimensions is either equal or 1, a dimension of 1 gets repeated to match the
+// other operand. This covers scalars, row vectors and column vectors
+bool MxBroadcastShape(const MxShape* left, const MxShape* right, MxShape* out)
 {
-	if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-		out->Shape = right->Shape;
+	if ((left->Height != right->Height && left->Height != 1 && right->Height != 1)
+		|| (left->Width != right->Width && left->Width != 1 && right->Width != 1)) {
+		return false;
+	}
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[0] + right->Data[i];
-		}
+	out->Height = left->Height > right->Height ? left->Height : right->Height;
+	out->Width = left->Width > right->Width ? left->Width : right->Width;
+	return true;
+}
 
-		return;
-	}
+typedef f64 (*MxElementFn)(f64 left, f64 right);
 
-	if (right->Shape.Height == 1 && right->Shape.Width == 1) {
-		out->Shape = left->Shape;
+static f64 ElementAdd(f64 left, f64 right) { return left + right; }
+
+static f64 ElementSubtract(f64 left, f64 right) { return left - right; }
+
+static f64 ElementMultiply(f64 left, f64 right) { return left * right; }
+
+static f64 ElementDivide(f64 left, f64 right) { return left / right; }
+
+static f64 ElementGreater(f64 left, f64 right) { return (f64)(left > right); }
+
+static f64 ElementGreaterEqual(f64 left, f64 right) { return (f64)(left >= right); }
+
+static f64 ElementLess(f64 left, f64 right) { return (f64)(left < right); }
+
+static f64 ElementLessEqual(f64 left, f64 right) { return (f64)(left <= right); }
+
+static f64 ElementEqualEqual(f64 left, f64 right) { return (f64)(left == right); }
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[i] + right->Data[0];
+static f64 ElementNotEqual(f64 left, f64 right) { return (f64)(left != right); }
+
+// Applies `fn` elementwise with broadcasting. Every row gets processed by a tight loop over contiguous memory, with a broadcast
+// column hoisted out as a scalar. It is `static inline` so that `fn` gets inlined and the row loops vectorized
+static inline void MxBroadcast(const Mx* left, const Mx* right, Mx* out, MxElementFn fn)
+{
+	MxBroadcastShape(&left->Shape, &right->Shape, &out->Shape);
+
+	usz height = out->Shape.Height;
+	usz width = out->Shape.Width;
+
+	// Same shapes mean same strides, contiguous ones are a single row as far as the loop is concerned
+	if (left->Shape.Height == right->Shape.Height && left->Shape.Width == right->Shape.Width) {
+		usz rows = MxIsContiguous(out) ? 1 : height;
+		usz rowLength = MxIsContiguous(out) ? height * width : width;
+
+		for (usz i = 0; i < rows; ++i) {
+			const f64* l = left->Data + (i * left->Stride);
+			const f64* r = right->Data + (i * right->Stride);
+			f64* o = out->Data + (i * out->Stride);
+
+			for (usz j = 0; j < rowLength; ++j) {
+				o[j] = fn(l[j], r[j]);
+			}
 		}
 
 		return;
 	}
 
-	out->Shape.Height = left->Shape.Height;
-	out->Shape.Width = left->Shape.Width;
+	usz leftRowStride = left->Shape.Height == 1 ? 0 : left->Stride;
+	usz rightRowStride = right->Shape.Height == 1 ? 0 : right->Stride;
+	bool leftIsColumn = left->Shape.Width == 1;
+	bool rightIsColumn = right->Shape.Width == 1;
+
+	for (usz i = 0; i < height; ++i) {
+		const f64* l = left->Data + (i * leftRowStride);
+		const f64* r = right->Data + (i * rightRowStride);
+		f64* o = out->Data + (i * out->Stride);
+
+		if (leftIsColumn && rightIsColumn) {
+			f64 lv = l[0];
+			f64 rv = r[0];
 
-	for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-		out->Data[i] = left->Data[i] + right->Data[i];
+			for (usz j = 0; j < width; ++j) {
+				o[j] = fn(lv, rv);
+			}
+		} else if (leftIsColumn) {
+			f64 lv = l[0];
+
+			for (usz j = 0; j < width; ++j) {
+				o[j] = fn(lv, r[j]);
+			}
+		} else if (rightIsColumn) {
+			f64 rv = r[0];
+
+			for (usz j = 0; j < width; ++j) {
+				o[j] = fn(l[j], rv);
+			}
+		} else {
+			for (usz j = 0; j < width; ++j) {
+				o[j] = fn(l[j], r[j]);
+			}
+		}
 	}
 }
 
-void MxSubtract(const Mx* left, const Mx* right, Mx* out)
-{
-	if (left->Shape.Height == 1 && left->Shape.Width == 1) {
-		out->Shape = right->Shape;
+void MxAdd(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementAdd); }
+
+void MxSubtract(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementSubtract); }
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[0] - right->Data[i];
+void MxElementMultiply(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementMultiply); }
+
+Result MxElementDivide(const Mx* left, const Mx* right, Mx* out)
+{
+	// Checked upfront, so that the division loop itself stays branch-free
+	bool hasZero = false;
+	for (usz i = 0; i < right->Shape.Height; ++i) {
+		for (usz j = 0; j < right->Shape.Width; ++j) {
+			hasZero |= right->Data[(i * right->Stride) + j] == 0;
 		}
+	}
 
-		return;
+	if (hasZero) {
+		return ResInvalidOperand;
 	}
 
-	if (right->Shape.Height == 1 && right->Shape.Width == 1) {
-		out->Shape = left->Shape;
+	MxBroadcast(left, right, out, ElementDivide);
+	return ResOk;
+}
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[i] - right->Data[0];
-		}
+void MxElementGreater(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementGreater); }
 
-		return;
-	}
+void MxElementGreaterEqual(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementGreaterEqual); }
 
-	out->Shape.Height = left->Shape.Height;
-	out->Shape.Width = left->Shape.Width;
+void MxElementLess(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementLess); }
+
+void MxElementLessEqual(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementLessEqual); }
 
-	for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-		out->Data[i] = left->Data[i] - right->Data[i];
+void MxElementEqualEqual(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementEqualEqual); }
+
+void MxElementNotEqual(const Mx* left, const Mx* right, Mx* out) { MxBroadcast(left, right, out, ElementNotEqual); }
+
+// Picks elements of `onTrue` where `mask` is non-zero and of `onFalse` elsewhere, broadcasting all three operands. `out` may alias
+// `onFalse` when they have the same shape, which is how masked assignments update a variable in place
+void MxSelect(const Mx* mask, const Mx* onTrue, const Mx* onFalse, Mx* out)
+{
+	MxShape valuesShape = { 0 };
+	MxBroadcastShape(&onTrue->Shape, &onFalse->Shape, &valuesShape);
+	MxBroadcastShape(&mask->Shape, &valuesShape, &out->Shape);
+
+	usz maskRowStride = mask->Shape.Height == 1 ? 0 : mask->Stride;
+	usz trueRowStride = onTrue->Shape.Height == 1 ? 0 : onTrue->Stride;
+	usz falseRowStride = onFalse->Shape.Height == 1 ? 0 : onFalse->Stride;
+	usz maskStep = mask->Shape.Width == 1 ? 0 : 1;
+	usz trueStep = onTrue->Shape.Width == 1 ? 0 : 1;
+	usz falseStep = onFalse->Shape.Width == 1 ? 0 : 1;
+
+	for (usz i = 0; i < out->Shape.Height; ++i) {
+		const f64* m = mask->Data + (i * maskRowStride);
+		const f64* t = onTrue->Data + (i * trueRowStride);
+		const f64* f = onFalse->Data + (i * falseRowStride);
+		f64* o = out->Data + (i * out->Stride);
+
+		// Both sides get loaded unconditionally, so this compiles down to a blend instead of a branch
+		for (usz j = 0; j < out->Shape.Width; ++j) {
+			f64 onTrueValue = t[j * trueStep];
+			f64 onFalseValue = f[j * falseStep];
+
+			o[j] = m[j * maskStep] != 0 ? onTrueValue : onFalseValue;
+		}
 	}
 }
 
@@ -103,8 +236,10 @@ void MxMultiply(const Mx* left, const Mx* right, Mx* out)
 	if (left->Shape.Height == 1 && left->Shape.Width == 1) {
 		out->Shape = right->Shape;
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[0] * right->Data[i];
+		for (usz i = 0; i < out->Shape.Height; ++i) {
+			for (usz j = 0; j < out->Shape.Width; ++j) {
+				out->Data[(i * out->Stride) + j] = left->Data[0] * right->Data[(i * right->Stride) + j];
+			}
 		}
 
 		return;
@@ -113,8 +248,10 @@ void MxMultiply(const Mx* left, const Mx* right, Mx* out)
 	if (right->Shape.Height == 1 && right->Shape.Width == 1) {
 		out->Shape = left->Shape;
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			out->Data[i] = left->Data[i] * right->Data[0];
+		for (usz i = 0; i < out->Shape.Height; ++i) {
+			for (usz j = 0; j < out->Shape.Width; ++j) {
+				out->Data[(i * out->Stride) + j] = left->Data[(i * left->Stride) + j] * right->Data[0];
+			}
 		}
 
 		return;
@@ -123,11 +260,13 @@ void MxMultiply(const Mx* left, const Mx* right, Mx* out)
 	out->Shape.Height = left->Shape.Height;
 	out->Shape.Width = right->Shape.Width;
 
+	// Buffers get reused, so the accumulators start out holding whatever was there before
+	memset(out->Data, 0, out->Shape.Height * out->Stride * sizeof(f64));
+
 	for (usz i = 0; i < left->Shape.Height; ++i) {
 		for (usz j = 0; j < right->Shape.Height; ++j) {
 			for (usz k = 0; k < right->Shape.Width; ++k) {
-				out->Data[(i * out->Shape.Width) + k]
-					+= left->Data[(i * left->Shape.Width) + j] * right->Data[(j * right->Shape.Width) + k];
+				out->Data[(i * out->Stride) + k] += left->Data[(i * left->Stride) + j] * right->Data[(j * right->Stride) + k];
 			}
 		}
 	}
@@ -138,12 +277,14 @@ Result MxDivide(const Mx* left, const Mx* right, Mx* out)
 	if (left->Shape.Height == 1 && left->Shape.Width == 1) {
 		out->Shape = right->Shape;
 
-		for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-			if (right->Data[i] == 0) {
-				return ResInvalidOperand;
-			}
+		for (usz i = 0; i < out->Shape.Height; ++i) {
+			for (usz j = 0; j < out->Shape.Width; ++j) {
+				if (right->Data[(i * right->Stride) + j] == 0) {
+					return ResInvalidOperand;
+				}
 
-			out->Data[i] = left->Data[0] / right->Data[i];
+				out->Data[(i * out->Stride) + j] = left->Data[0] / right->Data[(i * right->Stride) + j];
+			}
 		}
 
 		return ResOk;
@@ -155,14 +296,16 @@ Result MxDivide(const Mx* left, const Mx* right, Mx* out)
 
 	out->Shape = left->Shape;
 
-	for (usz i = 0; i < out->Shape.Height * out->Shape.Width; ++i) {
-		out->Data[i] = left->Data[i] / right->Data[0];
+	for (usz i = 0; i < out->Shape.Height; ++i) {
+		for (usz j = 0; j < out->Shape.Width; ++j) {
+			out->Data[(i * out->Stride) + j] = left->Data[(i * left->Stride) + j] / right->Data[0];
+		}
 	}
 
 	return ResOk;
 }
 
-Result MxToPower(const Mx* left, const Mx* right, Mx* out)
+Result MxToPower(const Mx* left, const Mx* right, Mx* out, Mx* temp)
 {
 	if (left->Shape.Height == 1 && left->Shape.Width == 1 && right->Shape.Height == 1 && right->Shape.Width == 1) {
 		out->Shape = left->Shape;
@@ -181,137 +324,188 @@ Result MxToPower(const Mx* left, const Mx* right, Mx* out)
 	out->Shape = left->Shape;
 
 	if (power == 0) {
-		memset(out->Data, 0, out->Shape.Height * out->Shape.Width * sizeof(f64));
+		memset(out->Data, 0, out->Shape.Height * out->Stride * sizeof(f64));
 
 		for (usz i = 0; i < out->Shape.Width; ++i) {
-			out->Data[(i * out->Shape.Width) + i] = 1;
+			out->Data[(i * out->Stride) + i] = 1;
 		}
 
 		return ResOk;
 	}
 
-	memcpy(out->Data, left->Data, out->Shape.Height * out->Shape.Width * sizeof(f64));
-
-	Mx* temp = InterpreterAllocMx(out->Shape.Height, out->Shape.Width);
+	MxCopy(left, out);
 
 	for (u64 i = 1; i < power; ++i) {
 		MxMultiply(out, left, temp);
-		memcpy(out->Data, temp->Data, out->Shape.Height * out->Shape.Width * sizeof(f64));
+		MxCopy(temp, out);
 	}
 
 	return ResOk;
 }
 
-void MxTranspose(const Mx* mx, Mx* out)
+f64 MxDeterminant(const Mx* mx, Mx* temp)
 {
-	out->Shape.Height = mx->Shape.Width;
-	out->Shape.Width = mx->Shape.Height;
+	MxCopy(mx, temp);
+
+	f64 det = 1.0;
+	int sign = 1;
 
 	for (usz i = 0; i < mx->Shape.Height; ++i) {
-		for (usz j = 0; j < mx->Shape.Width; ++j) {
-			out->Data[(j * out->Shape.Width) + i] = mx->Data[(i * mx->Shape.Width) + j];
+		usz pivot = i;
+		for (usz r = i; r < mx->Shape.Height; ++r) {
+			if (fabs(temp->Data[(r * temp->Stride) + i]) > fabs(temp->Data[(pivot * temp->Stride) + i]))
+				pivot = r;
+		}
+
+		if (fabs(temp->Data[(pivot * temp->Stride) + i]) < 1e-12) {
+			det = 0.0;
+			break;
+		}
+
+		if (pivot != i) {
+			for (usz c = 0; c < mx->Shape.Height; ++c) {
+				f64 tmp = temp->Data[(i * temp->Stride) + c];
+				temp->Data[(i * temp->Stride) + c] = temp->Data[(pivot * temp->Stride) + c];
+				temp->Data[(pivot * temp->Stride) + c] = tmp;
+			}
+
+			sign = -sign;
+		}
+
+		f64 piv = temp->Data[(i * temp->Stride) + i];
+		det *= piv;
+
+		for (usz r = i + 1; r < mx->Shape.Height; ++r) {
+			f64 f = temp->Data[(r * temp->Stride) + i] / piv;
+
+			for (usz c = i; c < mx->Shape.Height; ++c) {
+				temp->Data[(r * temp->Stride) + c] -= f * temp->Data[(i * temp->Stride) + c];
+			}
 		}
 	}
+
+	return det * sign;
 }
 
-void MxNegate(const Mx* mx, Mx* out)
+Result MxInverse(const Mx* mx, Mx* out, Mx* temp)
 {
-	out->Shape = mx->Shape;
+	memset(temp->Data, 0, mx->Shape.Height * temp->Stride * sizeof(f64));
 
-	for (usz i = 0; i < mx->Shape.Height * mx->Shape.Width; ++i) {
-		out->Data[i] = -mx->Data[i];
+	for (usz r = 0; r < mx->Shape.Height; ++r) {
+		for (usz c = 0; c < mx->Shape.Height; ++c)
+			temp->Data[(r * temp->Stride) + c] = mx->Data[(r * mx->Stride) + c];
+		temp->Data[(r * temp->Stride) + r + mx->Shape.Height] = 1.0;
 	}
-}
 
-void MxGreater(const Mx* left, const Mx* right, Mx* out)
-{
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+	for (usz i = 0; i < mx->Shape.Height; ++i) {
+		usz pivot = i;
+		for (usz r = i; r < mx->Shape.Height; ++r) {
+			if (fabs(temp->Data[(r * temp->Stride) + i]) > fabs(temp->Data[(pivot * temp->Stride) + i]))
+				pivot = r;
+		}
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] <= right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+		if (fabs(temp->Data[(pivot * temp->Stride) + i]) < 1e-12) {
+			return ResInvalidOperand;
 		}
-	}
-}
 
-void MxGreaterEqual(const Mx* left, const Mx* right, Mx* out)
-{
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+		if (pivot != i) {
+			for (usz c = 0; c < 2 * mx->Shape.Height; ++c) {
+				f64 tmp = temp->Data[(i * temp->Stride) + c];
+				temp->Data[(i * temp->Stride) + c] = temp->Data[(pivot * temp->Stride) + c];
+				temp->Data[(pivot * temp->Stride) + c] = tmp;
+			}
+		}
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] < right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+		f64 piv = temp->Data[(i * temp->Stride) + i];
+		for (usz c = 0; c < 2 * mx->Shape.Height; ++c) {
+			temp->Data[(i * temp->Stride) + c] /= piv;
 		}
-	}
-}
 
-void MxLess(const Mx* left, const Mx* right, Mx* out)
-{
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+		for (usz r = 0; r < mx->Shape.Height; ++r) {
+			if (r == i) {
+				continue;
+			}
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] >= right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+			f64 f = temp->Data[(r * temp->Stride) + i];
+			for (usz c = 0; c < 2 * mx->Shape.Height; ++c) {
+				temp->Data[(r * temp->Stride) + c] -= f * temp->Data[(i * temp->Stride) + c];
+			}
 		}
 	}
+
+	for (usz r = 0; r < mx->Shape.Height; ++r) {
+		for (usz c = 0; c < mx->Shape.Height; ++c) {
+			out->Data[(r * out->Stride) + c] = temp->Data[(r * temp->Stride) + c + mx->Shape.Height];
+		}
+	}
+
+	return ResOk;
 }
 
-void MxLessEqual(const Mx* left, const Mx* right, Mx* out)
+void MxTranspose(const Mx* mx, Mx* out)
 {
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+	out->Shape.Height = mx->Shape.Width;
+	out->Shape.Width = mx->Shape.Height;
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] > right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+	for (usz i = 0; i < mx->Shape.Height; ++i) {
+		for (usz j = 0; j < mx->Shape.Width; ++j) {
+			out->Data[(j * out->Stride) + i] = mx->Data[(i * mx->Stride) + j];
 		}
 	}
 }
 
-void MxEqualEqual(const Mx* left, const Mx* right, Mx* out)
+void MxNegate(const Mx* mx, Mx* out)
 {
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+	out->Shape = mx->Shape;
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] != right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+	for (usz i = 0; i < mx->Shape.Height; ++i) {
+		for (usz j = 0; j < mx->Shape.Width; ++j) {
+			out->Data[(i * out->Stride) + j] = -mx->Data[(i * mx->Stride) + j];
 		}
 	}
 }
 
-void MxNotEqual(const Mx* left, const Mx* right, Mx* out)
+// Whether `fn` holds for every pair of elements at the same position, the operands have the same shape
+static inline void MxCompareAll(const Mx* left, const Mx* right, Mx* out, MxElementFn fn)
 {
-	out->Shape.Height = 1;
-	out->Shape.Width = 1;
-	out->Data[0] = 1;
+	bool holds = true;
 
-	for (usz i = 0; i < left->Shape.Height * left->Shape.Width; ++i) {
-		if (left->Data[i] == right->Data[i]) {
-			out->Data[0] = 0;
-			break;
+	for (usz i = 0; i < left->Shape.Height && holds; ++i) {
+		const f64* l = left->Data + (i * left->Stride);
+		const f64* r = right->Data + (i * right->Stride);
+
+		for (usz j = 0; j < left->Shape.Width; ++j) {
+			if (fn(l[j], r[j]) == 0) {
+				holds = false;
+				break;
+			}
 		}
 	}
+
+	out->Shape.Height = 1;
+	out->Shape.Width = 1;
+	out->Data[0] = (f64)holds;
 }
 
+void MxGreater(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementGreater); }
+
+void MxGreaterEqual(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementGreaterEqual); }
+
+void MxLess(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementLess); }
+
+void MxLessEqual(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementLessEqual); }
+
+void MxEqualEqual(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementEqualEqual); }
+
+void MxNotEqual(const Mx* left, const Mx* right, Mx* out) { MxCompareAll(left, right, out, ElementNotEqual); }
+
 bool MxTruthy(const Mx* mx)
 {
-	for (usz i = 0; i < mx->Shape.Height * mx->Shape.Width; ++i) {
-		if (mx->Data[i] == 0) {
-			return false;
+	for (usz i = 0; i < mx->Shape.Height; ++i) {
+		for (usz j = 0; j < mx->Shape.Width; ++j) {
+			if (mx->Data[(i * mx->Stride) + j] == 0) {
+				return false;
+			}
 		}
 	}
 
@@ -329,7 +523,7 @@ void MxLogicalOr(const Mx* left, const Mx* right, Mx* out)
 	usz smallerSize = leftSize < rightSize ? leftSize : rightSize;
 
 	for (usz i = 0; i < smallerSize; ++i) {
-		if (!((bool)left->Data[i] || (bool)right->Data[i])) {
+		if (!((bool)MxFlatAt(left, i) || (bool)MxFlatAt(right, i))) {
 			out->Data[0] = 0;
 			break;
 		}
@@ -347,7 +541,7 @@ void MxLogicalAnd(const Mx* left, const Mx* right, Mx* out)
 	usz smallerSize = leftSize < rightSize ? leftSize : rightSize;
 
 	for (usz i = 0; i < smallerSize; ++i) {
-		if (!((bool)left->Data[i] && (bool)right->Data[i])) {
+		if (!((bool)MxFlatAt(left, i) && (bool)MxFlatAt(right, i))) {
 			out->Data[0] = 0;
 			break;
 		}
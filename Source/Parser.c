@@ -1,6 +1,7 @@
 #include "Parser.h"
 #include "Diagnostics.h"
 #include <stdio.h>
+#include <string.h>
 
 Parser g_parser = { 0 };
 
@@ -51,146 +52,275 @@ static void ParserSynchronize()
 	}
 }
 
-static ASTNode* ParseStatement();
-static ASTNode* ParseBlock();
-static ASTNode* ParseVarDecl();
-static ASTNode* ParseWhileStmt();
-static ASTNode* ParseIfStmt();
-static ASTNode* ParseExprOrAssignment();
-static ASTNode* ParseExpression();
-static ASTNode* ParseLogicAnd();
-static ASTNode* ParseEquality();
-static ASTNode* ParseComparison();
-static ASTNode* ParseTerm();
-static ASTNode* ParseFactor();
-static ASTNode* ParseExponent();
-static ASTNode* ParseUnary();
-static ASTNode* ParsePostfix();
-static ASTNode* ParsePrimary();
-static ASTNode* ParseIdentifierPrimary();
+static ASTNodeID ParserNewNode(ASTNodeType type, SourceLoc loc)
+{
+	ASTNode node = { .Type = type, .Loc = loc };
+	DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Nodes, &node));
+
+	return (ASTNodeID)(g_parser.Nodes.Count - 1);
+}
+
+static void ParserPushNode(ASTNodeID node) { DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.NodeScratch, &node)); }
+
+// Moves every node pushed since `mark` into the child array and pops them off the scratch stack, returns the index of the first one
+static u32 ParserCommitNodes(usz mark, u32* count)
+{
+	*count = (u32)(g_parser.NodeScratch.Count - mark);
+
+	u32 first = (u32)g_parser.Children.Count;
+	for (usz i = mark; i < g_parser.NodeScratch.Count; ++i) {
+		DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Children, DynArrayAt(&g_parser.NodeScratch, i)));
+	}
+
+	DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+	return first;
+}
+
+static ASTNodeID ParserNewNumber(f64 value, SourceLoc loc)
+{
+	DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Numbers, &value));
+
+	ASTNodeID number = ParserNewNode(ASTNodeNumber, loc);
+	ASTNode* node = ASTNodeGet(number);
+	node->Number.FirstValue = (u32)(g_parser.Numbers.Count - 1);
+	node->Number.Shape.Height = 1;
+	node->Number.Shape.Width = 1;
+
+	return number;
+}
+
+static bool ParserIsScalarNumber(ASTNodeID id)
+{
+	const ASTNode* node = ASTNodeGet(id);
+	return node && node->Type == ASTNodeNumber && node->Number.Shape.Height == 1 && node->Number.Shape.Width == 1;
+}
+
+// Collapses a literal whose elements (on the scratch stack since `mark`) are all plain numbers into a single number node.
+// Such elements are the only nodes created since they started, so they are dropped and their values get padded in place
+static ASTNodeID ParserFoldNumbers(usz mark, const usz* widths, usz height, usz maxWidth, SourceLoc loc)
+{
+	usz count = g_parser.NodeScratch.Count - mark;
+	if (count == 0) {
+		return AST_NODE_NONE;
+	}
+
+	for (usz i = mark; i < g_parser.NodeScratch.Count; ++i) {
+		if (!ParserIsScalarNumber(*(ASTNodeID*)DynArrayAt(&g_parser.NodeScratch, i))) {
+			return AST_NODE_NONE;
+		}
+	}
+
+	ASTNodeID firstID = *(ASTNodeID*)DynArrayAt(&g_parser.NodeScratch, mark);
+	u32 firstValue = ASTNodeGet(firstID)->Number.FirstValue;
+
+	f64 zero = 0;
+	while (g_parser.Numbers.Count < firstValue + (height * maxWidth)) {
+		DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Numbers, &zero));
+	}
+
+	// Rows only ever move towards the end, walking backwards never overwrites a value that is still to be moved
+	f64* values = (f64*)(void*)g_parser.Numbers.Items + firstValue;
+	usz element = count;
+	for (usz i = height; i-- > 0;) {
+		usz width = widths ? widths[i] : 1;
+
+		for (usz j = maxWidth; j-- > width;) {
+			values[(i * maxWidth) + j] = 0;
+		}
+
+		for (usz j = width; j-- > 0;) {
+			values[(i * maxWidth) + j] = values[--element];
+		}
+	}
+
+	DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+	DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.Nodes, firstID));
+
+	ASTNodeID number = ParserNewNode(ASTNodeNumber, loc);
+	ASTNode* node = ASTNodeGet(number);
+	node->Number.FirstValue = firstValue;
+	node->Number.Shape.Height = height;
+	node->Number.Shape.Width = maxWidth;
+
+	return number;
+}
+
+static ASTNodeID ParserNewBinary(ASTNodeID left, TokenType operator, ASTNodeID right)
+{
+	SourceLoc loc = left ? ASTNodeGet(left)->Loc : (SourceLoc) { 0 };
 
-static ASTNode* ParseIdentifierPrimary()
+	ASTNodeID binary = ParserNewNode(ASTNodeBinary, loc);
+	ASTNode* node = ASTNodeGet(binary);
+	node->Binary.Left = left;
+	node->Binary.Operator = operator;
+	node->Binary.Right = right;
+
+	return binary;
+}
+
+static ASTNodeID ParseStatement();
+static ASTNodeID ParseBlock();
+static ASTNodeID ParseVarDecl();
+static ASTNodeID ParseWhileStmt();
+static ASTNodeID ParseIfStmt();
+static ASTNodeID ParseExprOrAssignment();
+static ASTNodeID ParseExpression();
+static ASTNodeID ParseLogicAnd();
+static ASTNodeID ParseEquality();
+static ASTNodeID ParseComparison();
+static ASTNodeID ParseTerm();
+static ASTNodeID ParseFactor();
+static ASTNodeID ParseExponent();
+static ASTNodeID ParseUnary();
+static ASTNodeID ParsePostfix();
+static ASTNodeID ParsePrimary();
+static ASTNodeID ParseIdentifierPrimary();
+static ASTNodeID ParseIndexSuffix();
+static ASTNodeID ParseIndex();
+
+static ASTNodeID ParseIndex()
+{
+	SourceLoc loc = ParserPeek()->Loc;
+
+	// A whole dimension
+	if (ParserMatch(TokenColon)) {
+		return ParserNewNode(ASTNodeRange, loc);
+	}
+
+	ASTNodeID start = ParseExpression();
+
+	usz backup = g_tokenizer.Cursor;
+
+	if (!ParserMatch(TokenColon)) {
+		return start;
+	}
+
+	// In `A[i :]` the colon is the whole column dimension, not the end of a range
+	if (ParserPeek()->Type == TokenRightSquareBracket) {
+		g_tokenizer.Cursor = backup;
+		return start;
+	}
+
+	ASTNodeID end = ParseExpression();
+
+	ASTNodeID range = ParserNewNode(ASTNodeRange, loc);
+	ASTNodeGet(range)->Range.Start = start;
+	ASTNodeGet(range)->Range.End = end;
+	return range;
+}
+
+// Expects the opening '[' to already be consumed
+static ASTNodeID ParseIndexSuffix()
+{
+	SourceLoc loc = ParserPeek()->Loc;
+
+	ASTNodeID i = ParseIndex();
+	ASTNodeID j = AST_NODE_NONE;
+
+	if (ParserPeek()->Type != TokenRightSquareBracket) {
+		j = ParseIndex();
+	}
+
+	if (!ParserMatch(TokenRightSquareBracket)) {
+		DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightSquareBracket));
+		ParserSynchronize();
+		return AST_NODE_NONE;
+	}
+
+	ASTNodeID indexSuffix = ParserNewNode(ASTNodeIndexSuffix, loc);
+	ASTNodeGet(indexSuffix)->IndexSuffix.I = i;
+	ASTNodeGet(indexSuffix)->IndexSuffix.J = j;
+
+	return indexSuffix;
+}
+
+static ASTNodeID ParseIdentifierPrimary()
 {
 	SourceLoc loc = ParserPeek()->Loc;
 	SymbolView identifier = ParserConsume()->Lexeme;
 
 	// A function call
 	if (ParserMatch(TokenLeftRoundBracket)) {
-		ASTNode* functionCall;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&functionCall));
-
-		functionCall->Type = ASTNodeFunctionCall;
-		functionCall->Loc = loc;
-		functionCall->FnCall.Identifier = identifier;
-		DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&functionCall->FnCall.CallArgs, 3 * sizeof(ASTNode*)));
-
+		usz mark = g_parser.NodeScratch.Count;
 		usz i = 0;
 		while (ParserPeek()->Type != TokenRightRoundBracket) {
 			if (i > 0) {
 				if (!ParserMatch(TokenComma)) {
 					DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenComma));
 					ParserSynchronize();
-					return nullptr;
+					DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+					return AST_NODE_NONE;
 				}
 			}
 
 			if (i > 2) {
-				DIAG_EMIT(DiagTooManyFunctionCallArgs, functionCall->Loc, DIAG_ARG_SYMBOL_VIEW(functionCall->FnCall.Identifier));
+				DIAG_EMIT(DiagTooManyFunctionCallArgs, loc, DIAG_ARG_SYMBOL_VIEW(identifier));
 				ParserSynchronize();
-				return nullptr;
+				DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+				return AST_NODE_NONE;
 			}
 
-			functionCall->FnCall.CallArgs[i] = ParseExpression();
+			ParserPushNode(ParseExpression());
 			++i;
 		}
 
 		if (!ParserMatch(TokenRightRoundBracket)) {
 			DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightRoundBracket));
 			ParserSynchronize();
-			return nullptr;
+			DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+			return AST_NODE_NONE;
 		}
-		functionCall->FnCall.ArgCount = i;
+
+		u32 argCount;
+		u32 firstArg = ParserCommitNodes(mark, &argCount);
+
+		ASTNodeID functionCall = ParserNewNode(ASTNodeFunctionCall, loc);
+		ASTNode* node = ASTNodeGet(functionCall);
+		node->FnCall.Identifier = identifier;
+		node->FnCall.FirstArg = firstArg;
+		node->FnCall.ArgCount = argCount;
 
 		return functionCall;
 	}
 
 	// Not a function call
-	ASTNode* indexSuffix = nullptr;
+	ASTNodeID indexSuffix = AST_NODE_NONE;
 	if (ParserMatch(TokenLeftSquareBracket)) {
-		ASTNode* i;
-		i = ParseExpression();
-		ASTNode* j = nullptr;
-
-		if (ParserPeek()->Type != TokenRightSquareBracket) {
-			j = ParseExpression();
-		}
-
-		if (!ParserMatch(TokenRightSquareBracket)) {
-			DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightSquareBracket));
-			ParserSynchronize();
-			return nullptr;
+		indexSuffix = ParseIndexSuffix();
+		if (!indexSuffix) {
+			return AST_NODE_NONE;
 		}
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&indexSuffix));
-
-		indexSuffix->Type = ASTNodeIndexSuffix;
-		indexSuffix->IndexSuffix.I = i;
-		indexSuffix->IndexSuffix.J = j;
 	}
 
-	ASTNode* astIdentifier;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&astIdentifier));
-
-	astIdentifier->Type = ASTNodeIdentifier;
-	astIdentifier->Loc = loc;
-	astIdentifier->Identifier.Identifier = identifier;
-	astIdentifier->Identifier.Index = indexSuffix;
+	ASTNodeID astIdentifier = ParserNewNode(ASTNodeIdentifier, loc);
+	ASTNodeGet(astIdentifier)->Identifier.Identifier = identifier;
+	ASTNodeGet(astIdentifier)->Identifier.Index = indexSuffix;
 
 	return astIdentifier;
 }
 
-static ASTNode* ParsePrimary()
+static ASTNodeID ParsePrimary()
 {
 	Token token = *ParserPeek();
 
 	if (token.Type == TokenNumber) {
-		ASTNode* number;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&number));
-
-		number->Type = ASTNodeMxLiteral;
-		number->Loc = token.Loc;
-		DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&number->MxLiteral.Matrix, sizeof(ASTNode*)));
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&number->MxLiteral.Matrix[0]));
-
 		ParserAdvance();
 
-		number->MxLiteral.Matrix[0]->Type = ASTNodeNumber;
-		number->MxLiteral.Matrix[0]->Loc = token.Loc;
-		number->MxLiteral.Matrix[0]->Number = token.Number;
-		number->MxLiteral.Shape.Height = 1;
-		number->MxLiteral.Shape.Width = 1;
-
-		return number;
+		return ParserNewNumber(token.Number, token.Loc);
 	}
 
 	if (ParserMatch(TokenLeftRoundBracket)) {
-		ASTNode* expression;
-		expression = ParseExpression();
-
-		ASTNode* grouping;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&grouping));
-
-		grouping->Type = ASTNodeGrouping;
-		grouping->Loc = token.Loc;
-		grouping->Grouping.Expression = expression;
+		ASTNodeID expression = ParseExpression();
 
 		if (!ParserMatch(TokenRightRoundBracket)) {
 			DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightRoundBracket));
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
 
+		ASTNodeID grouping = ParserNewNode(ASTNodeGrouping, token.Loc);
+		ASTNodeGet(grouping)->Grouping.Expression = expression;
+
 		return grouping;
 	}
 
@@ -199,84 +329,72 @@ static ASTNode* ParsePrimary()
 	}
 
 	if (ParserMatch(TokenLeftSquareBracket)) {
-		ASTNode* matrixLit;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&matrixLit));
-
-		matrixLit->Type = ASTNodeMxLiteral;
-		matrixLit->Loc = token.Loc;
-
 		if (ParserMatch(TokenRightSquareBracket)) {
 			DIAG_EMIT0(DiagEmptyMxLiteralsNotAllowed, ParserPeek()->Loc);
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
 
-		Tokenizer backup = g_tokenizer;
+		usz nodeMark = g_parser.NodeScratch.Count;
+		usz widthMark = g_parser.WidthScratch.Count;
 		usz height = 0;
-		usz width = 0;
 		usz maxWidth = 0;
 		do {
+			usz width = 0;
 			while (ParserPeek()->Type != TokenRightSquareBracket && ParserPeek()->Type != TokenEof) {
-				ParseExpression();
+				ParserPushNode(ParseExpression());
 				++width;
 			}
 
 			if (!ParserMatch(TokenRightSquareBracket)) {
 				DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightSquareBracket));
 				ParserSynchronize();
-				return nullptr;
+				DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, nodeMark));
+				DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.WidthScratch, widthMark));
+				return AST_NODE_NONE;
 			}
 
 			if (width > maxWidth) {
 				maxWidth = width;
 			}
 
+			DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.WidthScratch, &width));
 			++height;
-			width = 0;
 		} while (ParserMatch(TokenLeftSquareBracket));
 
-		DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&matrixLit->MxLiteral.Matrix, height * maxWidth * sizeof(ASTNode*)));
-
-		g_tokenizer = backup;
-		usz i = 0;
-		usz j = 0;
-		do {
-			while (ParserPeek()->Type != TokenRightSquareBracket) {
-				matrixLit->MxLiteral.Matrix[(i * maxWidth) + j] = ParseExpression();
-				++j;
-			}
-
-			while (j < maxWidth) {
-				ASTNode* zero;
-				DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&zero));
-
-				zero->Type = ASTNodeMxLiteral;
-				DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&zero->MxLiteral.Matrix, sizeof(ASTNode*)));
-
-				DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&zero->MxLiteral.Matrix[0]));
-
-				zero->MxLiteral.Matrix[0]->Type = ASTNodeNumber;
-				zero->MxLiteral.Matrix[0]->Number = 0;
-				zero->MxLiteral.Shape.Height = 1;
-				zero->MxLiteral.Shape.Width = 1;
+		ASTNodeID numbers
+			= ParserFoldNumbers(nodeMark, (const usz*)DynArrayAt(&g_parser.WidthScratch, widthMark), height, maxWidth, token.Loc);
+		if (numbers) {
+			DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.WidthScratch, widthMark));
+			return numbers;
+		}
 
-				matrixLit->MxLiteral.Matrix[(i * maxWidth) + j] = zero;
+		// Rows shorter than the widest one get padded with zeros
+		usz zeroMark = g_parser.NodeScratch.Count;
+		for (usz i = zeroMark - nodeMark; i < height * maxWidth; ++i) {
+			ParserPushNode(ParserNewNumber(0, token.Loc));
+		}
 
-				++j;
-			}
+		u32 firstElement = (u32)g_parser.Children.Count;
+		usz element = nodeMark;
+		usz zero = zeroMark;
+		for (usz i = 0; i < height; ++i) {
+			usz width = *(usz*)DynArrayAt(&g_parser.WidthScratch, widthMark + i);
 
-			if (!ParserMatch(TokenRightSquareBracket)) {
-				DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightSquareBracket));
-				ParserSynchronize();
-				return nullptr;
+			for (usz j = 0; j < maxWidth; ++j) {
+				usz from = j < width ? element++ : zero++;
+				DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Children, DynArrayAt(&g_parser.NodeScratch, from)));
 			}
+		}
 
-			++i;
-			j = 0;
-		} while (ParserMatch(TokenLeftSquareBracket));
+		DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, nodeMark));
+		DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.WidthScratch, widthMark));
 
-		matrixLit->MxLiteral.Shape.Height = height;
-		matrixLit->MxLiteral.Shape.Width = maxWidth;
+		ASTNodeID matrixLit = ParserNewNode(ASTNodeMxLiteral, token.Loc);
+		ASTNode* node = ASTNodeGet(matrixLit);
+		node->MxLiteral.FirstElement = firstElement;
+		node->MxLiteral.Shape.Height = height;
+		node->MxLiteral.Shape.Width = maxWidth;
 
 		return matrixLit;
 	}
@@ -284,329 +402,259 @@ static ASTNode* ParsePrimary()
 	if (token.Type == TokenLeftVectorBracket) {
 		ParserAdvance();
 
-		ASTNode* vectorLit;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&vectorLit));
-
-		vectorLit->Type = ASTNodeMxLiteral;
-		vectorLit->Loc = token.Loc;
-		vectorLit->MxLiteral.Shape.Width = 1;
-
 		if (ParserMatch(TokenRightVectorBracket)) {
 			DIAG_EMIT0(DiagEmptyVecLiteralsNotAllowed, ParserPeek()->Loc);
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
 
-		Tokenizer backup = g_tokenizer;
-		usz count = 0;
+		usz mark = g_parser.NodeScratch.Count;
 		while (ParserPeek()->Type != TokenRightVectorBracket && ParserPeek()->Type != TokenEof) {
-			ParseExpression();
-			++count;
-		}
-
-		DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&vectorLit->MxLiteral.Matrix, count * sizeof(ASTNode*)));
-
-		g_tokenizer = backup;
-
-		usz i = 0;
-		while (ParserPeek()->Type != TokenRightVectorBracket && ParserPeek()->Type != TokenEof) {
-			vectorLit->MxLiteral.Matrix[i] = ParseExpression();
-			++i;
+			ParserPushNode(ParseExpression());
 		}
 
 		if (!ParserMatch(TokenRightVectorBracket)) {
 			DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightVectorBracket));
 			ParserSynchronize();
-			return nullptr;
+			DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+			return AST_NODE_NONE;
 		}
 
-		vectorLit->MxLiteral.Shape.Height = i;
+		ASTNodeID numbers = ParserFoldNumbers(mark, nullptr, g_parser.NodeScratch.Count - mark, 1, token.Loc);
+		if (numbers) {
+			return numbers;
+		}
+
+		u32 count;
+		u32 firstElement = ParserCommitNodes(mark, &count);
+
+		ASTNodeID vectorLit = ParserNewNode(ASTNodeMxLiteral, token.Loc);
+		ASTNode* node = ASTNodeGet(vectorLit);
+		node->MxLiteral.FirstElement = firstElement;
+		node->MxLiteral.Shape.Height = count;
+		node->MxLiteral.Shape.Width = 1;
 
 		return vectorLit;
 	}
 
 	DIAG_EMIT(DiagUnexpectedToken, token.Loc, DIAG_ARG_TOKEN(token));
 	ParserSynchronize();
-	return nullptr;
+	return AST_NODE_NONE;
 }
 
-static ASTNode* ParsePostfix()
+static ASTNodeID ParsePostfix()
 {
-	ASTNode* primary = ParsePrimary();
+	ASTNodeID primary = ParsePrimary();
 
 	if (ParserPeek()->Type == TokenTranspose) {
 		TokenType operator = ParserPeek()->Type;
+		SourceLoc loc = primary ? ASTNodeGet(primary)->Loc : ParserPeek()->Loc;
 		ParserAdvance();
 
-		ASTNode* postfix;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&postfix));
-
-		postfix->Type = ASTNodeUnary;
-		postfix->Loc = primary->Loc;
-		postfix->Unary.Operator = operator;
-		postfix->Unary.Operand = primary;
+		ASTNodeID postfix = ParserNewNode(ASTNodeUnary, loc);
+		ASTNodeGet(postfix)->Unary.Operator = operator;
+		ASTNodeGet(postfix)->Unary.Operand = primary;
 		return postfix;
 	}
 
 	return primary;
 }
 
-static ASTNode* ParseExponent()
+static ASTNodeID ParseExponent()
 {
-	ASTNode* left = ParsePostfix();
+	ASTNodeID left = ParsePostfix();
 
 	while (ParserPeek()->Type == TokenToPower) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
+		ASTNodeID right = ParsePostfix();
 
-		ASTNode* right = ParsePostfix();
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
-
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseUnary()
+static ASTNodeID ParseUnary()
 {
 	if (ParserPeek()->Type == TokenSubtract) {
 		TokenType operator = ParserPeek()->Type;
 		SourceLoc loc = ParserPeek()->Loc;
 		ParserAdvance();
 
-		ASTNode* operand = ParseUnary();
+		ASTNodeID operand = ParseUnary();
 
-		ASTNode* unary;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&unary));
+		// Negative numbers stay plain numbers, so literals of them can still be folded
+		ASTNode* node = ASTNodeGet(operand);
+		if (node && node->Type == ASTNodeNumber) {
+			f64* values = ASTNodeValues(node);
+			for (usz i = 0; i < node->Number.Shape.Height * node->Number.Shape.Width; ++i) {
+				values[i] = -values[i];
+			}
 
-		unary->Type = ASTNodeUnary;
-		unary->Loc = loc;
-		unary->Unary.Operator = operator;
-		unary->Unary.Operand = operand;
+			node->Loc = loc;
+			return operand;
+		}
+
+		ASTNodeID unary = ParserNewNode(ASTNodeUnary, loc);
+		ASTNodeGet(unary)->Unary.Operator = operator;
+		ASTNodeGet(unary)->Unary.Operand = operand;
 		return unary;
 	}
 
 	return ParseExponent();
 }
 
-static ASTNode* ParseFactor()
+static ASTNodeID ParseFactor()
 {
-	ASTNode* left = ParseUnary();
+	ASTNodeID left = ParseUnary();
 
-	while (ParserPeek()->Type == TokenMultiply || ParserPeek()->Type == TokenDivide) {
+	while (ParserPeek()->Type == TokenMultiply || ParserPeek()->Type == TokenDivide || ParserPeek()->Type == TokenElementMultiply
+		|| ParserPeek()->Type == TokenElementDivide) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
-
-		ASTNode* right = ParseUnary();
+		ASTNodeID right = ParseUnary();
 
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
-
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseTerm()
+static ASTNodeID ParseTerm()
 {
-	ASTNode* left = ParseFactor();
+	ASTNodeID left = ParseFactor();
 
 	while (ParserPeek()->Type == TokenAdd || ParserPeek()->Type == TokenSubtract) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
-
-		ASTNode* right = ParseFactor();
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
+		ASTNodeID right = ParseFactor();
 
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseComparison()
+static ASTNodeID ParseComparison()
 {
-	ASTNode* left = ParseTerm();
+	ASTNodeID left = ParseTerm();
 
 	while (ParserPeek()->Type == TokenLess || ParserPeek()->Type == TokenLessEqual || ParserPeek()->Type == TokenGreater
-		|| ParserPeek()->Type == TokenGreaterEqual) {
+		|| ParserPeek()->Type == TokenGreaterEqual || ParserPeek()->Type == TokenElementLess || ParserPeek()->Type == TokenElementLessEqual
+		|| ParserPeek()->Type == TokenElementGreater || ParserPeek()->Type == TokenElementGreaterEqual) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
+		ASTNodeID right = ParseTerm();
 
-		ASTNode* right = ParseTerm();
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
-
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseEquality()
+static ASTNodeID ParseEquality()
 {
-	ASTNode* left = ParseComparison();
+	ASTNodeID left = ParseComparison();
 
-	while (ParserPeek()->Type == TokenEqualEqual || ParserPeek()->Type == TokenNotEqual) {
+	while (ParserPeek()->Type == TokenEqualEqual || ParserPeek()->Type == TokenNotEqual || ParserPeek()->Type == TokenElementEqualEqual
+		|| ParserPeek()->Type == TokenElementNotEqual) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
-
-		ASTNode* right = ParseComparison();
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
+		ASTNodeID right = ParseComparison();
 
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseLogicAnd()
+static ASTNodeID ParseLogicAnd()
 {
-	ASTNode* left = ParseEquality();
+	ASTNodeID left = ParseEquality();
 
 	while (ParserPeek()->Type == TokenAnd) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
+		ASTNodeID right = ParseEquality();
 
-		ASTNode* right = ParseEquality();
-
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
-
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseExpression()
+static ASTNodeID ParseExpression()
 {
-	ASTNode* left = ParseLogicAnd();
+	ASTNodeID left = ParseLogicAnd();
 
 	while (ParserPeek()->Type == TokenOr) {
 		TokenType operator = ParserPeek()->Type;
 		ParserAdvance();
 
-		ASTNode* temp = left;
-
-		ASTNode* right = ParseLogicAnd();
+		ASTNodeID right = ParseLogicAnd();
 
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&left));
-
-		left->Type = ASTNodeBinary;
-		left->Loc = temp->Loc;
-		left->Binary.Left = temp;
-		left->Binary.Operator = operator;
-		left->Binary.Right = right;
+		left = ParserNewBinary(left, operator, right);
 	}
 
 	return left;
 }
 
-static ASTNode* ParseExprOrAssignment()
+static ASTNodeID ParseExprOrAssignment()
 {
 	Token* token = ParserPeek();
 	SourceLoc loc = token->Loc;
 	if (token->Type == TokenIdentifier) {
 		SymbolView identifier = token->Lexeme;
 
-		Tokenizer backup = g_tokenizer;
+		usz backup = g_tokenizer.Cursor;
 
 		ParserAdvance();
 
-		ASTNode* indexSuffix = nullptr;
+		ASTNodeID indexSuffix = AST_NODE_NONE;
 		if (ParserMatch(TokenLeftSquareBracket)) {
-			ASTNode* i = ParseExpression();
-			ASTNode* j = nullptr;
-
-			token = ParserPeek();
-			if (token->Type != TokenRightSquareBracket) {
-				j = ParseExpression();
-			}
-
-			if (!ParserMatch(TokenRightSquareBracket)) {
-				DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightSquareBracket));
-				ParserSynchronize();
-				return nullptr;
+			indexSuffix = ParseIndexSuffix();
+			if (!indexSuffix) {
+				return AST_NODE_NONE;
 			}
-
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&indexSuffix));
-
-			indexSuffix->Type = ASTNodeIndexSuffix;
-			indexSuffix->IndexSuffix.I = i;
-			indexSuffix->IndexSuffix.J = j;
 		}
 
 		// This is an assignment
 		if (ParserMatch(TokenEqual)) {
-			ASTNode* assignment;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&assignment));
+			ASTNodeID expression = ParseExpression();
 
-			assignment->Type = ASTNodeAssignment;
-			assignment->Loc = loc;
-			assignment->Assignment.Identifier = identifier;
-			assignment->Assignment.Index = indexSuffix;
-			assignment->Assignment.Expression = ParseExpression();
+			ASTNodeID assignment = ParserNewNode(ASTNodeAssignment, loc);
+			ASTNode* node = ASTNodeGet(assignment);
+			node->Assignment.Identifier = identifier;
+			node->Assignment.Index = indexSuffix;
+			node->Assignment.Expression = expression;
 
 			return assignment;
 		}
 
 		// Not an assignment
-		g_tokenizer = backup;
+		g_tokenizer.Cursor = backup;
 	}
 
 	return ParseExpression();
 }
 
-static ASTNode* ParseIfStmt()
+static ASTNodeID ParseIfStmt()
 {
 	SourceLoc loc = ParserPeek()->Loc;
 	ParserAdvance();
 
-	ASTNode* condition = ParseExpression();
+	ASTNodeID condition = ParseExpression();
 
-	ASTNode* body = ParseBlock();
+	ASTNodeID body = ParseBlock();
 
-	ASTNode* elseBody = nullptr;
+	ASTNodeID elseBody = AST_NODE_NONE;
 	if (ParserMatch(TokenElse)) {
 		Token* token = ParserPeek();
 		if (token->Type == TokenIf) {
@@ -616,38 +664,31 @@ static ASTNode* ParseIfStmt()
 		}
 	}
 
-	ASTNode* ifStmt;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&ifStmt));
-
-	ifStmt->Type = ASTNodeIfStmt;
-	ifStmt->Loc = loc;
-	ifStmt->IfStmt.Condition = condition;
-	ifStmt->IfStmt.ThenBlock = body;
-	ifStmt->IfStmt.ElseBlock = elseBody;
+	ASTNodeID ifStmt = ParserNewNode(ASTNodeIfStmt, loc);
+	ASTNode* node = ASTNodeGet(ifStmt);
+	node->IfStmt.Condition = condition;
+	node->IfStmt.ThenBlock = body;
+	node->IfStmt.ElseBlock = elseBody;
 
 	return ifStmt;
 }
 
-static ASTNode* ParseWhileStmt()
+static ASTNodeID ParseWhileStmt()
 {
 	SourceLoc loc = ParserPeek()->Loc;
 	ParserAdvance();
 
-	ASTNode* condition = ParseExpression();
+	ASTNodeID condition = ParseExpression();
 
-	ASTNode* body = ParseBlock();
+	ASTNodeID body = ParseBlock();
 
-	ASTNode* whileStmt;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&whileStmt));
-
-	whileStmt->Type = ASTNodeWhileStmt;
-	whileStmt->Loc = loc;
-	whileStmt->WhileStmt.Body = body;
-	whileStmt->WhileStmt.Condition = condition;
+	ASTNodeID whileStmt = ParserNewNode(ASTNodeWhileStmt, loc);
+	ASTNodeGet(whileStmt)->WhileStmt.Body = body;
+	ASTNodeGet(whileStmt)->WhileStmt.Condition = condition;
 	return whileStmt;
 }
 
-static ASTNode* ParseVarDecl()
+static ASTNodeID ParseVarDecl()
 {
 	Token* token = ParserConsume();
 	SourceLoc loc = token->Loc;
@@ -657,109 +698,87 @@ static ASTNode* ParseVarDecl()
 	if (token->Type != TokenIdentifier) {
 		DIAG_EMIT(DiagExpectedToken, token->Loc, DIAG_ARG_TOKEN_TYPE(TokenIdentifier));
 		ParserSynchronize();
-		return nullptr;
+		return AST_NODE_NONE;
 	}
 
-	ASTNode* varDecl;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&varDecl));
-
-	varDecl->Type = ASTNodeVarDecl;
-	varDecl->Loc = loc;
-	varDecl->VarDecl.IsConst = isConst;
-	varDecl->VarDecl.HasDeclaredShape = false;
-	varDecl->VarDecl.Identifier = ParserPeek()->Lexeme;
+	SymbolView identifier = token->Lexeme;
 	ParserAdvance();
 
+	MxShape shape = { 0 };
+	bool hasDeclaredShape = false;
 	if (ParserMatch(TokenColon)) {
 		token = ParserConsume();
 		if (token->Type != TokenMatrixShape) {
 			DIAG_EMIT(DiagExpectedToken, token->Loc, DIAG_ARG_TOKEN_TYPE(TokenMatrixShape));
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
 
 		if (token->MatrixShape.Height < 1 || token->MatrixShape.Width < 1) {
 			DIAG_EMIT0(DiagInvalidMxShape, token->Loc);
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
 
-		varDecl->VarDecl.Shape = token->MatrixShape;
-		varDecl->VarDecl.HasDeclaredShape = true;
+		shape = token->MatrixShape;
+		hasDeclaredShape = true;
 	}
 
+	ASTNodeID expression = AST_NODE_NONE;
 	if (!ParserMatch(TokenEqual)) {
-		if (!varDecl->VarDecl.HasDeclaredShape) {
+		if (!hasDeclaredShape) {
 			DIAG_EMIT(DiagExpectedToken, ParserPeek()->Loc, DIAG_ARG_TOKEN_TYPE(TokenColon));
 			ParserSynchronize();
-			return nullptr;
+			return AST_NODE_NONE;
 		}
-
-		varDecl->VarDecl.Expression = nullptr;
-		return varDecl;
+	} else {
+		expression = ParseExpression();
 	}
 
-	varDecl->VarDecl.Expression = ParseExpression();
+	ASTNodeID varDecl = ParserNewNode(ASTNodeVarDecl, loc);
+	ASTNode* node = ASTNodeGet(varDecl);
+	node->VarDecl.IsConst = isConst;
+	node->VarDecl.HasDeclaredShape = hasDeclaredShape;
+	node->VarDecl.Identifier = identifier;
+	node->VarDecl.Shape = shape;
+	node->VarDecl.Expression = expression;
 
 	return varDecl;
 }
 
-static ASTNode* ParseBlock()
+static ASTNodeID ParseBlock()
 {
 	SourceLoc loc = ParserPeek()->Loc;
 	if (!ParserMatch(TokenLeftCurlyBracket)) {
 		DIAG_EMIT(DiagExpectedToken, loc, DIAG_ARG_TOKEN_TYPE(TokenLeftCurlyBracket));
 		ParserSynchronize();
-		return nullptr;
+		return AST_NODE_NONE;
 	}
 
-	ASTNode* block;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&block));
-
-	block->Type = ASTNodeBlock;
-	block->Loc = loc;
-
-	Tokenizer backup = g_tokenizer;
-
-	usz count = 0;
+	usz mark = g_parser.NodeScratch.Count;
 	while (!ParserMatch(TokenRightCurlyBracket)) {
 		Token* token = ParserPeek();
 		if (token->Type == TokenEof) {
 			DIAG_EMIT(DiagExpectedToken, token->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightCurlyBracket));
 			ParserSynchronize();
-			return nullptr;
+			DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_parser.NodeScratch, mark));
+			return AST_NODE_NONE;
 		}
 
-		ParseStatement();
-		++count;
+		ParserPushNode(ParseStatement());
 	}
 
-	DIAG_PANIC_ON_ERR(DynArenaAlloc(&g_parser.ArraysArena, (void**)&block->Block.Nodes, count * sizeof(ASTNode*)));
+	u32 nodeCount;
+	u32 firstNode = ParserCommitNodes(mark, &nodeCount);
 
-	g_tokenizer = backup;
-
-	usz i = 0;
-	while (!ParserMatch(TokenRightCurlyBracket)) {
-		Token* token = ParserPeek();
-		if (token->Type == TokenEof) {
-			DIAG_EMIT(DiagExpectedToken, token->Loc, DIAG_ARG_TOKEN_TYPE(TokenRightCurlyBracket));
-			ParserSynchronize();
-			return nullptr;
-		}
-
-		ASTNode* statement = ParseStatement();
-
-		block->Block.Nodes[i] = statement;
-
-		++i;
-	}
-
-	block->Block.NodeCount = i;
+	ASTNodeID block = ParserNewNode(ASTNodeBlock, loc);
+	ASTNodeGet(block)->Block.FirstNode = firstNode;
+	ASTNodeGet(block)->Block.NodeCount = nodeCount;
 
 	return block;
 }
 
-static ASTNode* ParseStatement()
+static ASTNodeID ParseStatement()
 {
 	Token* token = ParserPeek();
 	switch (token->Type) {
@@ -779,56 +798,32 @@ static ASTNode* ParseStatement()
 
 void ParserParse()
 {
-	ASTNode* topLevelBlock;
-	DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_parser.ASTArena, (void**)&topLevelBlock));
-
-	topLevelBlock->Type = ASTNodeBlock;
-
-	Tokenizer backup = g_tokenizer;
-
-	usz count = 0;
+	bool empty = true;
 	while (true) {
 		Token* token = ParserPeek();
 		if (token->Type == TokenEof) {
 			break;
 		}
 
-		ASTNode* node = ParseStatement();
-		if (!node) {
-			continue;
-		}
+		empty = false;
 
-		++count;
-	}
-
-	if (count < 1) {
-		return;
-	}
-
-	DIAG_PANIC_ON_ERR(DynArenaAllocZeroed(&g_parser.ArraysArena, (void**)&topLevelBlock->Block.Nodes, count * sizeof(ASTNode*)));
-
-	g_tokenizer = backup;
-
-	usz i = 0;
-	while (true) {
-		Token* token = ParserPeek();
-		if (token->Type == TokenEof) {
-			break;
-		}
-
-		ASTNode* node = ParseStatement();
+		ASTNodeID node = ParseStatement();
 		if (!node) {
 			continue;
 		}
 
-		topLevelBlock->Block.Nodes[i] = node;
-
-		++i;
+		ParserPushNode(node);
 	}
 
-	topLevelBlock->Block.NodeCount = i;
+	u32 nodeCount;
+	u32 firstNode = ParserCommitNodes(0, &nodeCount);
 
-	if (i < 1) {
+	g_parser.Root = ParserNewNode(ASTNodeBlock, (SourceLoc) { 0 });
+	ASTNodeGet(g_parser.Root)->Block.FirstNode = firstNode;
+	ASTNodeGet(g_parser.Root)->Block.NodeCount = nodeCount;
+
+	// Files where every statement failed to parse already got their errors
+	if (empty) {
 		DIAG_EMIT0(DiagEmptyFileParsed, ParserPeek()->Loc);
 	}
 }
@@ -845,15 +840,30 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 	}
 
 	switch (node->Type) {
-	case ASTNodeNumber:
-		printf("%lf", node->Number);
+	case ASTNodeNumber: {
+		const f64* values = ASTNodeValues(node);
+		if (node->Number.Shape.Height == 1 && node->Number.Shape.Width == 1) {
+			printf("%lf", values[0]);
+			break;
+		}
+
+		printf("(num %zux%zu ", node->Number.Shape.Height, node->Number.Shape.Width);
+		for (usz i = 0; i < node->Number.Shape.Height; ++i) {
+			printf("(row");
+			for (usz j = 0; j < node->Number.Shape.Width; ++j) {
+				printf(" %lf", values[(i * node->Number.Shape.Width) + j]);
+			}
+			printf(")");
+		}
+		printf(")");
 		break;
+	}
 	case ASTNodeMxLiteral:
 		printf("(lit %zux%zu ", node->MxLiteral.Shape.Height, node->MxLiteral.Shape.Width);
 		for (size_t i = 0; i < node->MxLiteral.Shape.Height; ++i) {
 			printf("(row ");
 			for (size_t j = 0; j < node->MxLiteral.Shape.Width; ++j) {
-				ParserPrintAST(node->MxLiteral.Matrix[(i * node->MxLiteral.Shape.Width) + j], 0);
+				ParserPrintAST(ASTNodeChild(node->MxLiteral.FirstElement, (i * node->MxLiteral.Shape.Width) + j), 0);
 
 				if (j < node->MxLiteral.Shape.Width - 1) {
 					printf(" ");
@@ -865,8 +875,8 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 		break;
 	case ASTNodeBlock:
 		printf("(block\n");
-		for (size_t i = 0; i < node->Block.NodeCount; ++i) {
-			ParserPrintAST(node->Block.Nodes[i], indents + 2);
+		for (u32 i = 0; i < node->Block.NodeCount; ++i) {
+			ParserPrintAST(ASTNodeChild(node->Block.FirstNode, i), indents + 2);
 			printf("\n");
 		}
 		for (usz i = 0; i < indents; ++i) {
@@ -876,19 +886,19 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 		break;
 	case ASTNodeUnary:
 		printf("(un %u ", node->Unary.Operator);
-		ParserPrintAST(node->Unary.Operand, 0);
+		ParserPrintAST(ASTNodeGet(node->Unary.Operand), 0);
 		printf(")");
 		break;
 	case ASTNodeGrouping:
 		printf("(grouping ");
-		ParserPrintAST(node->Grouping.Expression, 0);
+		ParserPrintAST(ASTNodeGet(node->Grouping.Expression), 0);
 		printf(")");
 		break;
 	case ASTNodeBinary:
 		printf("(bin %u ", node->Binary.Operator);
-		ParserPrintAST(node->Binary.Left, 0);
+		ParserPrintAST(ASTNodeGet(node->Binary.Left), 0);
 		printf(" ");
-		ParserPrintAST(node->Binary.Right, 0);
+		ParserPrintAST(ASTNodeGet(node->Binary.Right), 0);
 		printf(")");
 		break;
 	case ASTNodeVarDecl:
@@ -902,14 +912,14 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 			printf(": %zux%zu", node->VarDecl.Shape.Height, node->VarDecl.Shape.Width);
 		}
 		printf(" = ");
-		ParserPrintAST(node->VarDecl.Expression, 0);
+		ParserPrintAST(ASTNodeGet(node->VarDecl.Expression), 0);
 		printf(")");
 		break;
 	case ASTNodeWhileStmt:
 		printf("(while ");
-		ParserPrintAST(node->WhileStmt.Condition, 0);
+		ParserPrintAST(ASTNodeGet(node->WhileStmt.Condition), 0);
 		printf("\n");
-		ParserPrintAST(node->WhileStmt.Body, indents + 2);
+		ParserPrintAST(ASTNodeGet(node->WhileStmt.Body), indents + 2);
 		printf("\n");
 		for (usz i = 0; i < indents; ++i) {
 			putchar(' ');
@@ -918,12 +928,12 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 		break;
 	case ASTNodeIfStmt:
 		printf("(if ");
-		ParserPrintAST(node->IfStmt.Condition, 0);
+		ParserPrintAST(ASTNodeGet(node->IfStmt.Condition), 0);
 		printf(" then\n");
-		ParserPrintAST(node->IfStmt.ThenBlock, indents + 2);
+		ParserPrintAST(ASTNodeGet(node->IfStmt.ThenBlock), indents + 2);
 		if (node->IfStmt.ElseBlock) {
 			printf(" else\n");
-			ParserPrintAST(node->IfStmt.ElseBlock, indents + 2);
+			ParserPrintAST(ASTNodeGet(node->IfStmt.ElseBlock), indents + 2);
 		}
 		printf("\n");
 		for (usz i = 0; i < indents; ++i) {
@@ -933,26 +943,36 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 		break;
 	case ASTNodeIndexSuffix:
 		printf("(index ");
-		ParserPrintAST(node->IndexSuffix.I, 0);
+		ParserPrintAST(ASTNodeGet(node->IndexSuffix.I), 0);
 		if (node->IndexSuffix.J) {
 			printf(" ");
-			ParserPrintAST(node->IndexSuffix.J, 0);
+			ParserPrintAST(ASTNodeGet(node->IndexSuffix.J), 0);
+		}
+		printf(")");
+		break;
+	case ASTNodeRange:
+		printf("(range");
+		if (node->Range.Start) {
+			printf(" ");
+			ParserPrintAST(ASTNodeGet(node->Range.Start), 0);
+			printf(" ");
+			ParserPrintAST(ASTNodeGet(node->Range.End), 0);
 		}
 		printf(")");
 		break;
 	case ASTNodeAssignment:
 		printf("(assignment %.*s", (i32)node->Assignment.Identifier.SymbolLength, node->Assignment.Identifier.Symbol);
 		if (node->Assignment.Index) {
-			ParserPrintAST(node->Assignment.Index, 0);
+			ParserPrintAST(ASTNodeGet(node->Assignment.Index), 0);
 		}
 		printf(" ");
-		ParserPrintAST(node->Assignment.Expression, 0);
+		ParserPrintAST(ASTNodeGet(node->Assignment.Expression), 0);
 		printf(")");
 		break;
 	case ASTNodeIdentifier:
 		printf("(ident %.*s", (i32)node->Identifier.Identifier.SymbolLength, node->Identifier.Identifier.Symbol);
 		if (node->Identifier.Index) {
-			ParserPrintAST(node->Identifier.Index, 0);
+			ParserPrintAST(ASTNodeGet(node->Identifier.Index), 0);
 		}
 		printf(")");
 		break;
@@ -960,7 +980,7 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 		printf("(call %.*s", (i32)node->FnCall.Identifier.SymbolLength, node->FnCall.Identifier.Symbol);
 		for (size_t i = 0; i < node->FnCall.ArgCount; ++i) {
 			printf(" (arg ");
-			ParserPrintAST(node->FnCall.CallArgs[i], 0);
+			ParserPrintAST(ASTNodeChild(node->FnCall.FirstArg, i), 0);
 			printf(")");
 		}
 		printf(")");
@@ -970,14 +990,30 @@ void ParserPrintAST(const ASTNode* node, usz indents)
 
 void ParserInit()
 {
-	DIAG_PANIC_ON_ERR(StatArenaInit(&g_parser.ASTArena, sizeof(ASTNode)));
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_parser.Nodes, sizeof(ASTNode)));
+
+	// Reserves AST_NODE_NONE
+	ASTNode none = { 0 };
+	DIAG_PANIC_ON_ERR(DynArrayPush(&g_parser.Nodes, &none));
 
-	DIAG_PANIC_ON_ERR(DynArenaInit(&g_parser.ArraysArena));
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_parser.Children, sizeof(ASTNodeID)));
+
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_parser.Numbers, sizeof(f64)));
+
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_parser.NodeScratch, sizeof(ASTNodeID)));
+
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_parser.WidthScratch, sizeof(usz)));
 }
 
 void ParserDeinit()
 {
-	DIAG_PANIC_ON_ERR(DynArenaDeinit(&g_parser.ArraysArena));
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_parser.WidthScratch));
+
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_parser.NodeScratch));
+
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_parser.Numbers));
+
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_parser.Children));
 
-	DIAG_PANIC_ON_ERR(StatArenaDeinit(&g_parser.ASTArena));
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_parser.Nodes));
 }
@@ -0,0 +1,350 @@
+#include "Planner.h"
+
+#include "Diagnostics.h"
+#include "Functions.h"
+#include "TypeChecker.h"
+#include <stdlib.h>
+#include <string.h>
+
+Planner g_planner = { 0 };
+
+static constexpr PlannerRange NO_RANGE = { 0, 0 };
+
+static void PlannerRemoveFreeRange(usz index)
+{
+	PlannerRange* ranges = (PlannerRange*)(void*)g_planner.FreeRanges.Items;
+	memmove(ranges + index, ranges + index + 1, (g_planner.FreeRanges.Count - index - 1) * sizeof(PlannerRange));
+	--g_planner.FreeRanges.Count;
+}
+
+// Best fit among the free ranges, the slab only grows when none of them is big enough
+static PlannerRange PlannerAlloc(usz size)
+{
+	PlannerRange* ranges = (PlannerRange*)(void*)g_planner.FreeRanges.Items;
+	usz count = g_planner.FreeRanges.Count;
+
+	usz best = count;
+	for (usz i = 0; i < count; ++i) {
+		if (ranges[i].Size >= size && (best == count || ranges[i].Size < ranges[best].Size)) {
+			best = i;
+		}
+	}
+
+	if (best < count) {
+		PlannerRange range = { ranges[best].Offset, size };
+
+		ranges[best].Offset += size;
+		ranges[best].Size -= size;
+		if (ranges[best].Size == 0) {
+			PlannerRemoveFreeRange(best);
+		}
+
+		return range;
+	}
+
+	// A free range at the very end of the slab only needs to be grown
+	usz offset = g_planner.SlabBytes;
+	if (count > 0 && ranges[count - 1].Offset + ranges[count - 1].Size == g_planner.SlabBytes) {
+		offset = ranges[count - 1].Offset;
+		PlannerRemoveFreeRange(count - 1);
+	}
+
+	g_planner.SlabBytes = offset + size;
+	return (PlannerRange) { offset, size };
+}
+
+// Returns a range to the free list, merging it with its neighbours
+static void PlannerFree(PlannerRange range)
+{
+	if (range.Size == 0) {
+		return;
+	}
+
+	PlannerRange* ranges = (PlannerRange*)(void*)g_planner.FreeRanges.Items;
+	usz count = g_planner.FreeRanges.Count;
+
+	usz low = 0;
+	usz high = count;
+	while (low < high) {
+		usz middle = low + (high - low) / 2;
+
+		if (ranges[middle].Offset < range.Offset) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	bool mergePrev = low > 0 && ranges[low - 1].Offset + ranges[low - 1].Size == range.Offset;
+	bool mergeNext = low < count && range.Offset + range.Size == ranges[low].Offset;
+
+	if (mergePrev && mergeNext) {
+		ranges[low - 1].Size += range.Size + ranges[low].Size;
+		PlannerRemoveFreeRange(low);
+	} else if (mergePrev) {
+		ranges[low - 1].Size += range.Size;
+	} else if (mergeNext) {
+		ranges[low].Offset = range.Offset;
+		ranges[low].Size += range.Size;
+	} else {
+		DIAG_PANIC_ON_ERR(DynArrayPush(&g_planner.FreeRanges, &range));
+
+		ranges = (PlannerRange*)(void*)g_planner.FreeRanges.Items;
+		memmove(ranges + low + 1, ranges + low, (count - low) * sizeof(PlannerRange));
+		ranges[low] = range;
+	}
+}
+
+// Everything still on the live stack above `mark` is no longer needed
+static void PlannerFreeLive(usz mark)
+{
+	for (usz i = mark; i < g_planner.LiveRanges.Count; ++i) {
+		PlannerFree(*(PlannerRange*)DynArrayAt(&g_planner.LiveRanges, i));
+	}
+
+	DIAG_PANIC_ON_ERR(DynArrayTruncate(&g_planner.LiveRanges, mark));
+}
+
+// Places the matrix a node evaluates to, followed by the scratch space it needs while doing so
+static PlannerRange PlannerAllocNode(ASTNode* node, MxShape scratch)
+{
+	usz size = PlannerMxBytes(TypeCheckerShapeOf(node));
+	if (HasValue(scratch)) {
+		size += PlannerMxBytes(scratch);
+	}
+
+	PlannerRange range = PlannerAlloc(size);
+	g_planner.Offsets[ASTNodeIDOf(node)] = range.Offset;
+
+	return range;
+}
+
+// Whether every element of the result only depends on the elements of the operands at the same position
+static bool PlannerIsElementwise(ASTNode* binary)
+{
+	switch (binary->Binary.Operator) {
+	case TokenAdd:
+	case TokenSubtract:
+	case TokenElementMultiply:
+	case TokenElementDivide:
+	case TokenElementGreater:
+	case TokenElementGreaterEqual:
+	case TokenElementLess:
+	case TokenElementLessEqual:
+	case TokenElementEqualEqual:
+	case TokenElementNotEqual:
+		return true;
+	case TokenMultiply:
+	case TokenDivide: {
+		MxShape left = TypeCheckerShapeOf(ASTNodeGet(binary->Binary.Left));
+		MxShape right = TypeCheckerShapeOf(ASTNodeGet(binary->Binary.Right));
+
+		return (left.Height == 1 && left.Width == 1) || (right.Height == 1 && right.Width == 1);
+	}
+	default:
+		return false;
+	}
+}
+
+// An elementwise result can be written straight over an operand of the same shape, every operand is a temporary that dies
+// with the node using it
+static bool PlannerCanOverwrite(ASTNode* node, ASTNode* operand, PlannerRange range)
+{
+	MxShape shape = TypeCheckerShapeOf(node);
+	MxShape operandShape = TypeCheckerShapeOf(operand);
+
+	return range.Size > 0 && shape.Height == operandShape.Height && shape.Width == operandShape.Width;
+}
+
+// The node's matrix takes over the range of an operand
+static PlannerRange PlannerTakeOver(ASTNode* node, PlannerRange operand)
+{
+	g_planner.Offsets[ASTNodeIDOf(node)] = operand.Offset;
+	g_planner.InPlace[ASTNodeIDOf(node)] = true;
+
+	return operand;
+}
+
+// Mirrors the order in which the interpreter evaluates a node, returning the range its value lives in. Whoever uses the value
+// frees the range once it is done with it
+static PlannerRange PlannerVisit(ASTNode* node)
+{
+	if (!node) {
+		return NO_RANGE;
+	}
+
+	switch (node->Type) {
+	case ASTNodeNumber:
+		return PlannerAllocNode(node, NO_SHAPE);
+	case ASTNodeMxLiteral: {
+		PlannerRange range = PlannerAllocNode(node, NO_SHAPE);
+
+		// Elements are evaluated and copied in one at a time
+		for (usz i = 0; i < node->MxLiteral.Shape.Height * node->MxLiteral.Shape.Width; ++i) {
+			PlannerFree(PlannerVisit(ASTNodeChild(node->MxLiteral.FirstElement, i)));
+		}
+
+		return range;
+	}
+	case ASTNodeUnary: {
+		PlannerRange operand = PlannerVisit(ASTNodeGet(node->Unary.Operand));
+
+		// Negation happens in place
+		if (node->Unary.Operator == TokenSubtract) {
+			return PlannerTakeOver(node, operand);
+		}
+
+		PlannerRange range = PlannerAllocNode(node, NO_SHAPE);
+		PlannerFree(operand);
+		return range;
+	}
+	case ASTNodeGrouping: {
+		PlannerRange range = PlannerVisit(ASTNodeGet(node->Grouping.Expression));
+		g_planner.Offsets[ASTNodeIDOf(node)] = range.Offset;
+		return range;
+	}
+	case ASTNodeBinary: {
+		PlannerRange left = PlannerVisit(ASTNodeGet(node->Binary.Left));
+		PlannerRange right = PlannerVisit(ASTNodeGet(node->Binary.Right));
+
+		if (PlannerIsElementwise(node)) {
+			if (PlannerCanOverwrite(node, ASTNodeGet(node->Binary.Left), left)) {
+				PlannerFree(right);
+				return PlannerTakeOver(node, left);
+			}
+
+			if (PlannerCanOverwrite(node, ASTNodeGet(node->Binary.Right), right)) {
+				PlannerFree(left);
+				return PlannerTakeOver(node, right);
+			}
+		}
+
+		// Matrix powers multiply through a temporary of the result's shape
+		PlannerRange range = PlannerAllocNode(node, node->Binary.Operator == TokenToPower ? TypeCheckerShapeOf(node) : NO_SHAPE);
+
+		PlannerFree(left);
+		PlannerFree(right);
+		return range;
+	}
+	case ASTNodeBlock: {
+		usz mark = g_planner.LiveRanges.Count;
+
+		for (usz i = 0; i < node->Block.NodeCount; ++i) {
+			ASTNode* statement = ASTNodeChild(node->Block.FirstNode, i);
+			PlannerRange range = PlannerVisit(statement);
+
+			// Variables stay until the end of the block
+			if (statement->Type == ASTNodeVarDecl) {
+				DIAG_PANIC_ON_ERR(DynArrayPush(&g_planner.LiveRanges, &range));
+			} else {
+				PlannerFree(range);
+			}
+		}
+
+		PlannerFreeLive(mark);
+		return NO_RANGE;
+	}
+	case ASTNodeIfStmt:
+		PlannerFree(PlannerVisit(ASTNodeGet(node->IfStmt.Condition)));
+		PlannerFree(PlannerVisit(ASTNodeGet(node->IfStmt.ThenBlock)));
+		PlannerFree(PlannerVisit(ASTNodeGet(node->IfStmt.ElseBlock)));
+		return NO_RANGE;
+	case ASTNodeWhileStmt:
+		// Every iteration starts with only the same outer variables alive, so one pass over the body plans all of them
+		PlannerFree(PlannerVisit(ASTNodeGet(node->WhileStmt.Condition)));
+		PlannerFree(PlannerVisit(ASTNodeGet(node->WhileStmt.Body)));
+		return NO_RANGE;
+	case ASTNodeVarDecl: {
+		// The variable exists before its initializer is evaluated
+		PlannerRange range = PlannerAlloc(PlannerMxBytes(node->VarDecl.Shape));
+		g_planner.Offsets[ASTNodeIDOf(node)] = range.Offset;
+
+		PlannerFree(PlannerVisit(ASTNodeGet(node->VarDecl.Expression)));
+		return range;
+	}
+	case ASTNodeIndexSuffix: {
+		// Indices are read as soon as they are evaluated, ranges are constants and are never evaluated
+		ASTNode* i = ASTNodeGet(node->IndexSuffix.I);
+		if (i->Type != ASTNodeRange) {
+			PlannerFree(PlannerVisit(i));
+		}
+
+		ASTNode* j = ASTNodeGet(node->IndexSuffix.J);
+		if (j && j->Type != ASTNodeRange) {
+			PlannerFree(PlannerVisit(j));
+		}
+
+		return NO_RANGE;
+	}
+	case ASTNodeAssignment: {
+		PlannerRange value = PlannerVisit(ASTNodeGet(node->Assignment.Expression));
+		PlannerVisit(ASTNodeGet(node->Assignment.Index));
+
+		PlannerFree(value);
+		return NO_RANGE;
+	}
+	case ASTNodeIdentifier:
+		PlannerVisit(ASTNodeGet(node->Identifier.Index));
+		return PlannerAllocNode(node, NO_SHAPE);
+	case ASTNodeFunctionCall: {
+		usz mark = g_planner.LiveRanges.Count;
+
+		for (usz i = 0; i < node->FnCall.ArgCount; ++i) {
+			PlannerRange arg = PlannerVisit(ASTNodeChild(node->FnCall.FirstArg, i));
+			DIAG_PANIC_ON_ERR(DynArrayPush(&g_planner.LiveRanges, &arg));
+		}
+
+		// Like setwhere, which still needs its mask while evaluating the values
+		if (!HasValue(TypeCheckerShapeOf(node))) {
+			PlannerFreeLive(mark);
+			return NO_RANGE;
+		}
+
+		if (FuncIsElementwise(node)) {
+			for (usz i = 0; i < node->FnCall.ArgCount; ++i) {
+				PlannerRange* arg = DynArrayAt(&g_planner.LiveRanges, mark + i);
+				if (!PlannerCanOverwrite(node, ASTNodeChild(node->FnCall.FirstArg, i), *arg)) {
+					continue;
+				}
+
+				PlannerRange range = *arg;
+
+				// Handed over to the result instead of being freed with the other arguments
+				arg->Size = 0;
+				PlannerFreeLive(mark);
+				return PlannerTakeOver(node, range);
+			}
+		}
+
+		PlannerRange range = PlannerAllocNode(node, FuncScratchShape(node));
+
+		PlannerFreeLive(mark);
+		return range;
+	}
+	default:
+		return NO_RANGE;
+	}
+}
+
+void PlannerPlan()
+{
+	g_planner.Offsets = (usz*)calloc(g_parser.Nodes.Count, sizeof(usz));
+	g_planner.InPlace = (bool*)calloc(g_parser.Nodes.Count, sizeof(bool));
+	if (!g_planner.Offsets || !g_planner.InPlace) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_planner.FreeRanges, sizeof(PlannerRange)));
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_planner.LiveRanges, sizeof(PlannerRange)));
+
+	PlannerFree(PlannerVisit(ASTNodeGet(g_parser.Root)));
+}
+
+void PlannerDeinit()
+{
+	free((void*)g_planner.Offsets);
+	free((void*)g_planner.InPlace);
+
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_planner.FreeRanges));
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_planner.LiveRanges));
+}
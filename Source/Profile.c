@@ -0,0 +1,164 @@
+#include "Profile.h"
+
+#include "Diagnostics.h"
+#include "SourceManager.h"
+#include "Stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+Profile g_profile = { 0 };
+
+void ProfileInit()
+{
+	// Without any lines there is nothing to attribute time to, the profiler stays off
+	SourceBuildLineIndex();
+	if (g_source.LineCount == 0) {
+		return;
+	}
+
+	g_profile.NodeLines = (u32*)calloc(g_parser.Nodes.Count, sizeof(u32));
+	if (!g_profile.NodeLines) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	for (usz i = 1; i < g_parser.Nodes.Count; ++i) {
+		ASTNode* node = DynArrayAt(&g_parser.Nodes, i);
+		usz lineNumber;
+		usz linePos;
+		SourceResolveLoc(node->Loc, &lineNumber, &linePos);
+		g_profile.NodeLines[i] = (u32)lineNumber;
+	}
+
+	g_profile.LineCount = g_source.LineCount;
+	g_profile.Lines = (ProfileLine*)calloc(g_profile.LineCount, sizeof(ProfileLine));
+	if (!g_profile.Lines) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	g_profile.CurrentLine = 0;
+	g_profile.ChildNs = 0;
+	g_profile.Enabled = true;
+}
+
+ProfileFrame ProfileEnter(ASTNode* node)
+{
+	usz line = g_profile.NodeLines[ASTNodeIDOf(node)];
+
+	ProfileLine* entry = g_profile.Lines + line - 1;
+	if (!entry->Reached) {
+		entry->Reached = true;
+		entry->Parent = g_profile.CurrentLine;
+	}
+
+	ProfileFrame frame = { .OuterChildNs = g_profile.ChildNs, .OuterLine = g_profile.CurrentLine };
+	g_profile.ChildNs = 0;
+	g_profile.CurrentLine = line;
+
+	frame.StartNs = StatsNow();
+	return frame;
+}
+
+void ProfileLeave(ASTNode* node, ProfileFrame frame)
+{
+	u64 elapsedNs = StatsNow() - frame.StartNs;
+	u64 selfNs = elapsedNs - g_profile.ChildNs;
+
+	ProfileLine* entry = g_profile.Lines + g_profile.CurrentLine - 1;
+	entry->SelfNs += selfNs;
+	++entry->Evaluations;
+
+	if (node->Type == ASTNodeBinary || node->Type == ASTNodeUnary || node->Type == ASTNodeFunctionCall) {
+		entry->KernelNs += selfNs;
+	}
+
+	g_profile.ChildNs = frame.OuterChildNs + elapsedNs;
+	g_profile.CurrentLine = frame.OuterLine;
+}
+
+void ProfileMx(ASTNode* node, usz bytes)
+{
+	ProfileLine* entry = g_profile.Lines + g_profile.NodeLines[ASTNodeIDOf(node)] - 1;
+	++entry->MxCount;
+	entry->MxBytes += bytes;
+}
+
+static i32 ProfileLineLength(usz line)
+{
+	const char* start = g_source.Lines[line];
+	const char* end = line + 1 < g_source.LineCount ? g_source.Lines[line + 1] : g_source.Source + g_source.SourceLength;
+
+	while (end > start && (end[-1] == '\n' || end[-1] == '\r')) {
+		--end;
+	}
+
+	return (i32)(end - start);
+}
+
+void ProfilePrint()
+{
+	u64 totalNs = 0;
+	for (usz i = 0; i < g_profile.LineCount; ++i) {
+		totalNs += g_profile.Lines[i].SelfNs;
+	}
+
+	fprintf(stderr, "Profile\n");
+	fprintf(stderr, "%12s %7s %12s %12s %10s %14s %6s\n", "Self ms", "Self %", "Kernel ms", "Evaluations", "Matrices", "Bytes", "Line");
+
+	for (usz i = 0; i < g_profile.LineCount; ++i) {
+		ProfileLine* line = g_profile.Lines + i;
+
+		// Lines that never ran keep their source but no numbers
+		if (line->Reached) {
+			fprintf(stderr, "%12.3f %6.1f%% %12.3f %12zu %10zu %14zu", (f64)line->SelfNs / 1e6,
+				totalNs > 0 ? 100.0 * (f64)line->SelfNs / (f64)totalNs : 0.0, (f64)line->KernelNs / 1e6, line->Evaluations, line->MxCount,
+				line->MxBytes);
+		} else {
+			fprintf(stderr, "%12s %7s %12s %12s %10s %14s", "", "", "", "", "", "");
+		}
+
+		fprintf(stderr, " %6zu | %.*s\n", i + 1, ProfileLineLength(i), g_source.Lines[i]);
+	}
+
+	fprintf(stderr, "%12.3f\n", (f64)totalNs / 1e6);
+	fflush(stderr);
+}
+
+static void ProfileWriteStack(FILE* file, usz line, usz depth)
+{
+	usz parent = g_profile.Lines[line - 1].Parent;
+
+	// Parents are always reached before their children, the depth check only guards against a malformed chain
+	if (parent > 0 && depth < g_profile.LineCount) {
+		ProfileWriteStack(file, parent, depth + 1);
+		fputc(';', file);
+	}
+
+	fprintf(file, "%s:%zu", g_source.FileName, line);
+}
+
+bool ProfileWriteFolded(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		return false;
+	}
+
+	for (usz i = 0; i < g_profile.LineCount; ++i) {
+		if (g_profile.Lines[i].SelfNs == 0) {
+			continue;
+		}
+
+		ProfileWriteStack(file, i + 1, 0);
+		fprintf(file, " %llu\n", (unsigned long long)g_profile.Lines[i].SelfNs);
+	}
+
+	return fclose(file) == 0;
+}
+
+void ProfileDeinit()
+{
+	free((void*)g_profile.NodeLines);
+	free((void*)g_profile.Lines);
+
+	g_profile = (Profile) { 0 };
+}
@@ -0,0 +1,157 @@
+#include "Random.h"
+
+#include <math.h>
+
+Random g_random = { 0 };
+
+static constexpr u32 PHILOX_M0 = 0xD2511F53;
+static constexpr u32 PHILOX_M1 = 0xCD9E8D57;
+static constexpr u32 PHILOX_W0 = 0x9E3779B9;
+static constexpr u32 PHILOX_W1 = 0xBB67AE85;
+static constexpr usz PHILOX_ROUNDS = 10;
+
+static constexpr usz ZIGGURAT_LAYERS = 128;
+static constexpr f64 ZIGGURAT_R = 3.442619855899;
+static constexpr f64 ZIGGURAT_V = 9.91256303526217e-3;
+
+// Marsaglia & Tsang's ziggurat tables, filled in by `RandomInit`
+static u32 g_zigguratK[ZIGGURAT_LAYERS];
+static f64 g_zigguratW[ZIGGURAT_LAYERS];
+static f64 g_zigguratF[ZIGGURAT_LAYERS];
+
+static void Philox(u64 counterLow, u64 counterHigh, u64 seed, u32 out[4])
+{
+	u32 c0 = (u32)counterLow;
+	u32 c1 = (u32)(counterLow >> 32);
+	u32 c2 = (u32)counterHigh;
+	u32 c3 = (u32)(counterHigh >> 32);
+	u32 k0 = (u32)seed;
+	u32 k1 = (u32)(seed >> 32);
+
+	for (usz i = 0; i < PHILOX_ROUNDS; ++i) {
+		u64 product0 = (u64)PHILOX_M0 * c0;
+		u64 product1 = (u64)PHILOX_M1 * c2;
+
+		u32 next0 = (u32)(product1 >> 32) ^ c1 ^ k0;
+		u32 next2 = (u32)(product0 >> 32) ^ c3 ^ k1;
+		c1 = (u32)product1;
+		c3 = (u32)product0;
+		c0 = next0;
+		c2 = next2;
+
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+// Uniform in [0, 1) with the full 53 bits of precision
+static f64 ToUniform(u32 high, u32 low) { return (f64)((((u64)high << 32) | low) >> 11) * 0x1.0p-53; }
+
+static u64 RandomReserve(usz blockCount)
+{
+	u64 base = g_random.Counter;
+	g_random.Counter += blockCount;
+	return base;
+}
+
+void RandomInit(u64 seed)
+{
+	g_random.Seed = seed;
+	g_random.Counter = 0;
+
+	f64 m = 2147483648.0;
+	f64 d = ZIGGURAT_R;
+	f64 t = d;
+	f64 q = ZIGGURAT_V / exp(-0.5 * d * d);
+
+	g_zigguratK[0] = (u32)((d / q) * m);
+	g_zigguratK[1] = 0;
+	g_zigguratW[0] = q / m;
+	g_zigguratW[ZIGGURAT_LAYERS - 1] = d / m;
+	g_zigguratF[0] = 1.0;
+	g_zigguratF[ZIGGURAT_LAYERS - 1] = exp(-0.5 * d * d);
+
+	for (usz i = ZIGGURAT_LAYERS - 2; i >= 1; --i) {
+		d = sqrt(-2.0 * log((ZIGGURAT_V / d) + exp(-0.5 * d * d)));
+		g_zigguratK[i + 1] = (u32)((d / t) * m);
+		t = d;
+		g_zigguratF[i] = exp(-0.5 * d * d);
+		g_zigguratW[i] = d / m;
+	}
+}
+
+void RandomFillUniform(f64* out, usz count)
+{
+	// Each block yields 128 bits, enough for 2 doubles
+	usz blockCount = (count + 1) / 2;
+	u64 base = RandomReserve(blockCount);
+
+	for (usz i = 0; i < count / 2; ++i) {
+		u32 bits[4];
+		Philox(base + i, 0, g_random.Seed, bits);
+
+		out[2 * i] = ToUniform(bits[0], bits[1]);
+		out[(2 * i) + 1] = ToUniform(bits[2], bits[3]);
+	}
+
+	if (count % 2) {
+		u32 bits[4];
+		Philox(base + blockCount - 1, 0, g_random.Seed, bits);
+
+		out[count - 1] = ToUniform(bits[0], bits[1]);
+	}
+}
+
+// Every element owns its counter, retries of the rejection step go into the high half of the counter. That keeps each sample
+// independent of how many retries its neighbours needed
+static f64 ZigguratNormal(u64 counter)
+{
+	u64 attempt = 1;
+	u32 bits[4];
+	Philox(counter, attempt, g_random.Seed, bits);
+
+	while (true) {
+		i32 hz = (i32)bits[0];
+		usz iz = bits[0] & (ZIGGURAT_LAYERS - 1);
+		u32 absHz = hz < 0 ? (u32)(-(i64)hz) : (u32)hz;
+
+		if (absHz < g_zigguratK[iz]) {
+			return hz * g_zigguratW[iz];
+		}
+
+		if (iz == 0) {
+			// Sampling from the tail beyond R
+			while (true) {
+				f64 x = -log(1.0 - ToUniform(bits[1], bits[2])) / ZIGGURAT_R;
+				f64 y = -log(1.0 - ToUniform(bits[3], bits[0]));
+
+				if (y + y >= x * x) {
+					return hz > 0 ? ZIGGURAT_R + x : -ZIGGURAT_R - x;
+				}
+
+				Philox(counter, ++attempt, g_random.Seed, bits);
+			}
+		}
+
+		f64 x = hz * g_zigguratW[iz];
+		if (g_zigguratF[iz] + (ToUniform(bits[1], bits[2]) * (g_zigguratF[iz - 1] - g_zigguratF[iz])) < exp(-0.5 * x * x)) {
+			return x;
+		}
+
+		Philox(counter, ++attempt, g_random.Seed, bits);
+	}
+}
+
+void RandomFillNormal(f64* out, usz count)
+{
+	u64 base = RandomReserve(count);
+
+	for (usz i = 0; i < count; ++i) {
+		out[i] = ZigguratNormal(base + i);
+	}
+}
@@ -3,9 +3,18 @@
 #include "Diagnostics.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 Source g_source = { 0 };
 
+#ifdef _WIN32
 static Result ReadEntireFile(const char* filePath, const char** contents, usz* length)
 {
 	FILE* file = fopen(filePath, "rb");
@@ -40,28 +49,122 @@ static Result ReadEntireFile(const char* filePath, const char** contents, usz* l
 
 	return ResOk;
 }
+#else
+// The mapping is read-only and not NUL terminated, everything reading the source is bounded by its length
+static Result MapEntireFile(const char* filePath, const char** contents, usz* length)
+{
+	int file = open(filePath, O_RDONLY);
+	if (file < 0) {
+		return ResCouldNotOpenFile;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode)) {
+		close(file);
+		return ResCouldNotOpenFile;
+	}
+
+	*length = (usz)info.st_size;
+
+	// Empty mappings are not allowed
+	if (*length == 0) {
+		close(file);
+		*contents = "";
+		return ResOk;
+	}
+
+	void* mapping = mmap(nullptr, *length, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (mapping == MAP_FAILED) {
+		return ResOutOfMemory;
+	}
+
+	// The tokenizer reads the file front to back exactly once
+	madvise(mapping, *length, MADV_SEQUENTIAL);
+
+	*contents = mapping;
+	return ResOk;
+}
+#endif
 
 void SourceInit(const char* name)
 {
+#ifdef _WIN32
 	DIAG_PANIC_ON_ERR(ReadEntireFile(name, &g_source.Source, &g_source.SourceLength));
+#else
+	DIAG_PANIC_ON_ERR(MapEntireFile(name, &g_source.Source, &g_source.SourceLength));
+#endif
 
-	for (usz i = 0; i < g_source.SourceLength; ++i) {
-		if (g_source.Source[i] != '\n') {
-			continue;
-		}
+	// Locations are 32-bit offsets
+	if (g_source.SourceLength > UINT32_MAX) {
+		DIAG_PANIC_ON_ERR(ResInvalidParams);
+	}
 
-		++g_source.LineCount;
+	g_source.FileName = name;
+}
+
+// Only diagnostics and the per line reports need lines, so the index gets built the first time one of them asks
+void SourceBuildLineIndex()
+{
+	if (g_source.Lines) {
+		return;
 	}
 
+	const char* iter = g_source.Source;
+	const char* end = g_source.Source + g_source.SourceLength;
+
 	// The last line might not end with a \n
-	++g_source.LineCount;
+	g_source.LineCount = 1;
+	while ((iter = memchr(iter, '\n', (usz)(end - iter)))) {
+		++g_source.LineCount;
+		++iter;
+	}
 
-	g_source.Lines = (const char**)calloc(g_source.LineCount, sizeof(const char*));
-	g_source.FileName = name;
+	g_source.Lines = (const char**)malloc(g_source.LineCount * sizeof(const char*));
+	if (!g_source.Lines) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	iter = g_source.Source;
+	g_source.Lines[0] = iter;
+	for (usz line = 1; line < g_source.LineCount; ++line) {
+		iter = (const char*)memchr(iter, '\n', (usz)(end - iter)) + 1;
+		g_source.Lines[line] = iter;
+	}
+}
+
+void SourceResolveLoc(SourceLoc loc, usz* line, usz* linePos)
+{
+	SourceBuildLineIndex();
+
+	const char* target = g_source.Source + loc.Offset;
+
+	usz low = 0;
+	usz high = g_source.LineCount;
+	while (high - low > 1) {
+		usz middle = low + (high - low) / 2;
+
+		if (g_source.Lines[middle] <= target) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+
+	*line = low + 1;
+	*linePos = (usz)(target - g_source.Lines[low]) + 1;
 }
 
 void SourceDeinit()
 {
 	free((void*)g_source.Lines);
+
+#ifdef _WIN32
 	free((void*)g_source.Source);
+#else
+	if (g_source.SourceLength > 0) {
+		munmap((void*)g_source.Source, g_source.SourceLength);
+	}
+#endif
 }
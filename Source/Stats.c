@@ -0,0 +1,158 @@
+#include "Stats.h"
+
+#include "Interpreter.h"
+#include "MemReport.h"
+#include "Parser.h"
+#include "Planner.h"
+#include "Tokenizer.h"
+#include "TypeChecker.h"
+#include <stdio.h>
+#include <time.h>
+
+Stats g_stats = { 0 };
+
+static const char* const STATS_PHASE_NAMES[STATS_PHASE_COUNT] = {
+	[StatsPhaseSource] = "source",
+	[StatsPhaseCache] = "cache",
+	[StatsPhaseTokenize] = "tokenize",
+	[StatsPhaseParse] = "parse",
+	[StatsPhaseBind] = "bind",
+	[StatsPhaseTypeCheck] = "typeCheck",
+	[StatsPhasePlan] = "plan",
+	[StatsPhaseEstimate] = "estimate",
+	[StatsPhaseInterpret] = "interpret",
+};
+
+static const char* const STATS_NODE_NAMES[AST_NODE_TYPE_COUNT] = {
+	[ASTNodeMxLiteral] = "mxLiteral",
+	[ASTNodeBlock] = "block",
+	[ASTNodeUnary] = "unary",
+	[ASTNodeGrouping] = "grouping",
+	[ASTNodeBinary] = "binary",
+	[ASTNodeVarDecl] = "varDecl",
+	[ASTNodeWhileStmt] = "whileStmt",
+	[ASTNodeIfStmt] = "ifStmt",
+	[ASTNodeIndexSuffix] = "indexSuffix",
+	[ASTNodeRange] = "range",
+	[ASTNodeAssignment] = "assignment",
+	[ASTNodeIdentifier] = "identifier",
+	[ASTNodeNumber] = "number",
+	[ASTNodeFunctionCall] = "functionCall",
+};
+
+typedef struct StatsCount {
+	const char* Name;
+	usz Value;
+} StatsCount;
+
+static constexpr usz STATS_COUNT_COUNT = 6;
+
+u64 StatsNow()
+{
+	struct timespec now;
+#ifdef _WIN32
+	timespec_get(&now, TIME_UTC);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+
+	return (u64)now.tv_sec * 1000000000 + (u64)now.tv_nsec;
+}
+
+void StatsStart() { g_stats.LapStartNs = StatsNow(); }
+
+void StatsLap(StatsPhase phase)
+{
+	u64 now = StatsNow();
+	g_stats.PhaseNs[phase] += now - g_stats.LapStartNs;
+	g_stats.LapStartNs = now;
+}
+
+// What the front end and the planner produced. Node 0 only stands for a missing node and is left out
+static void StatsCollectCounts(StatsCount counts[STATS_COUNT_COUNT])
+{
+	counts[0] = (StatsCount) { "tokens", g_tokenizer.Tokens.Count };
+	counts[1] = (StatsCount) { "nodes", g_parser.Nodes.Count > 0 ? g_parser.Nodes.Count - 1 : 0 };
+	counts[2] = (StatsCount) { "children", g_parser.Children.Count };
+	counts[3] = (StatsCount) { "numbers", g_parser.Numbers.Count };
+	counts[4] = (StatsCount) { "variableSlots", g_typeChecker.VarSlotCount };
+	counts[5] = (StatsCount) { "slabBytes", g_planner.SlabBytes };
+}
+
+static void StatsPrintJson(const StatsCount counts[STATS_COUNT_COUNT], const MemReportEntry* entries, usz entryCount)
+{
+	u64 totalNs = 0;
+
+	fprintf(stderr, "{\"phases\":{");
+	for (usz i = 0; i < STATS_PHASE_COUNT; ++i) {
+		fprintf(stderr, "\"%s\":%llu,", STATS_PHASE_NAMES[i], (unsigned long long)g_stats.PhaseNs[i]);
+		totalNs += g_stats.PhaseNs[i];
+	}
+	fprintf(stderr, "\"total\":%llu},\"counts\":{", (unsigned long long)totalNs);
+
+	for (usz i = 0; i < STATS_COUNT_COUNT; ++i) {
+		fprintf(stderr, "%s\"%s\":%zu", i > 0 ? "," : "", counts[i].Name, counts[i].Value);
+	}
+	fprintf(stderr, "},\"memory\":[");
+
+	for (usz i = 0; i < entryCount; ++i) {
+		MemStats stats = entries[i].Stats;
+		fprintf(stderr, "%s{\"name\":\"%s\",\"requested\":%zu,\"reserved\":%zu,\"blocks\":%zu,\"peakRequested\":%zu,\"peakReserved\":%zu}",
+			i > 0 ? "," : "", entries[i].Name, stats.RequestedBytes, stats.ReservedBytes, stats.BlockCount, stats.PeakRequestedBytes,
+			stats.PeakReservedBytes);
+	}
+	fprintf(stderr, "],\"evaluations\":{");
+
+	for (usz i = 0; i < AST_NODE_TYPE_COUNT; ++i) {
+		fprintf(stderr, "%s\"%s\":%zu", i > 0 ? "," : "", STATS_NODE_NAMES[i], g_interpreter.EvalCounts[i]);
+	}
+	fprintf(stderr, "}}\n");
+}
+
+static void StatsPrintText(const StatsCount counts[STATS_COUNT_COUNT], const MemReportEntry* entries, usz entryCount)
+{
+	u64 totalNs = 0;
+
+	fprintf(stderr, "Phases\n");
+	for (usz i = 0; i < STATS_PHASE_COUNT; ++i) {
+		fprintf(stderr, "  %-18s %14.3f ms\n", STATS_PHASE_NAMES[i], (f64)g_stats.PhaseNs[i] / 1e6);
+		totalNs += g_stats.PhaseNs[i];
+	}
+	fprintf(stderr, "  %-18s %14.3f ms\n", "total", (f64)totalNs / 1e6);
+
+	fprintf(stderr, "Counts\n");
+	for (usz i = 0; i < STATS_COUNT_COUNT; ++i) {
+		fprintf(stderr, "  %-18s %14zu\n", counts[i].Name, counts[i].Value);
+	}
+
+	fprintf(stderr, "Memory\n");
+	fprintf(stderr, "  %-18s %14s %14s\n", "Container", "Reserved", "Peak reserved");
+	for (usz i = 0; i < entryCount; ++i) {
+		fprintf(stderr, "  %-18s %14zu %14zu\n", entries[i].Name, entries[i].Stats.ReservedBytes, entries[i].Stats.PeakReservedBytes);
+	}
+
+	// Kinds of nodes that never ran are left out
+	fprintf(stderr, "Evaluations\n");
+	for (usz i = 0; i < AST_NODE_TYPE_COUNT; ++i) {
+		if (g_interpreter.EvalCounts[i] > 0) {
+			fprintf(stderr, "  %-18s %14zu\n", STATS_NODE_NAMES[i], g_interpreter.EvalCounts[i]);
+		}
+	}
+}
+
+void StatsPrint(bool json)
+{
+	StatsCount counts[STATS_COUNT_COUNT];
+	StatsCollectCounts(counts);
+
+	MemReportEntry entries[MEM_REPORT_MAX_ENTRIES];
+	usz entryCount = MemReportCollect(entries);
+
+	if (json) {
+		StatsPrintJson(counts, entries, entryCount);
+	} else {
+		StatsPrintText(counts, entries, entryCount);
+	}
+
+	fflush(stderr);
+}
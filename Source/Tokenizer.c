@@ -1,9 +1,10 @@
 #include "Tokenizer.h"
 
 #include "Diagnostics.h"
+#include "Simd.h"
 #include "SourceManager.h"
-#include <ctype.h>
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 static MxShape ParseMatrixShape(const char* str, usz strLength)
@@ -55,10 +56,10 @@ static f64 ParseDouble(const char* str, usz strLength)
 		i64 exponentSign = 1;
 		str++;
 
-		if (*str == '-') {
+		if (str < strEnd && *str == '-') {
 			exponentSign = -1;
 			str++;
-		} else if (*str == '+') {
+		} else if (str < strEnd && *str == '+') {
 			str++;
 		}
 
@@ -75,18 +76,117 @@ static f64 ParseDouble(const char* str, usz strLength)
 
 Tokenizer g_tokenizer = { 0 };
 
-static char TokenizerConsume()
+static bool IsDigit(char c) { return (u8)(c - '0') < 10; }
+
+static bool IsAlpha(char c) { return (u8)(((u8)c | 0x20) - 'a') < 26; }
+
+static bool IsAlphanumeric(char c) { return IsDigit(c) || IsAlpha(c); }
+
+#ifdef MX_SSE2
+// Bytes above 0x7F are negative as signed chars and so never fall into any of the ranges
+static inline u32 MaskDigits(__m128i chunk)
+{
+	__m128i aboveZero = _mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1));
+	__m128i belowNine = _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1));
+	return (u32)_mm_movemask_epi8(_mm_and_si128(aboveZero, belowNine));
+}
+
+static inline u32 MaskAlphanumeric(__m128i chunk)
+{
+	__m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+	__m128i aboveA = _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1));
+	__m128i belowZ = _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1));
+	return MaskDigits(chunk) | (u32)_mm_movemask_epi8(_mm_and_si128(aboveA, belowZ));
+}
+
+static inline u32 MaskWhiteSpace(__m128i chunk)
+{
+	__m128i space = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+	__m128i tab = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'));
+	__m128i carriageReturn = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'));
+	__m128i newLine = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+	return (u32)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(space, tab), _mm_or_si128(carriageReturn, newLine)));
+}
+#endif
+
+static const char* SkipDigits(const char* iter, const char* end)
+{
+#ifdef MX_SSE2
+	while (end - iter >= 16) {
+		u32 rest = ~MaskDigits(_mm_loadu_si128((const __m128i*)(const void*)iter)) & 0xFFFF;
+		if (rest) {
+			return iter + CountTrailingZeros(rest);
+		}
+
+		iter += 16;
+	}
+#endif
+
+	while (iter < end && IsDigit(*iter)) {
+		++iter;
+	}
+
+	return iter;
+}
+
+static const char* SkipAlphanumeric(const char* iter, const char* end)
 {
-	++g_tokenizer.SourceLinePos;
-	return *g_tokenizer.LexemeCurrent++;
+#ifdef MX_SSE2
+	while (end - iter >= 16) {
+		u32 rest = ~MaskAlphanumeric(_mm_loadu_si128((const __m128i*)(const void*)iter)) & 0xFFFF;
+		if (rest) {
+			return iter + CountTrailingZeros(rest);
+		}
+
+		iter += 16;
+	}
+#endif
+
+	while (iter < end && IsAlphanumeric(*iter)) {
+		++iter;
+	}
+
+	return iter;
 }
 
-static void TokenizerAdvance()
+typedef struct Keyword {
+	const char* Keyword;
+	usz Length;
+	TokenType Type;
+} Keyword;
+
+// Perfect hash over the keywords, see KeywordHash
+static const Keyword g_keywords[16] = {
+	[0] = { "and", 3, TokenAnd },
+	[1] = { "else", 4, TokenElse },
+	[5] = { "or", 2, TokenOr },
+	[6] = { "const", 5, TokenConst },
+	[7] = { "if", 2, TokenIf },
+	[9] = { "let", 3, TokenLet },
+	[12] = { "while", 5, TokenWhile },
+};
+
+static inline usz KeywordHash(const char* str, usz strLength) { return ((u8)str[0] + ((usz)(u8)str[1] << 1) + strLength) & 15; }
+
+// Returns TokenIdentifier when the lexeme isn't a keyword
+static TokenType KeywordLookup(const char* str, usz strLength)
 {
-	++g_tokenizer.SourceLinePos;
-	++g_tokenizer.LexemeCurrent;
+	if (strLength < 2 || strLength > 5) {
+		return TokenIdentifier;
+	}
+
+	const Keyword* keyword = &g_keywords[KeywordHash(str, strLength)];
+	if (keyword->Length == strLength && memcmp(str, keyword->Keyword, strLength) == 0) {
+		return keyword->Type;
+	}
+
+	return TokenIdentifier;
 }
 
+static char TokenizerConsume() { return *g_tokenizer.LexemeCurrent++; }
+
+static void TokenizerAdvance() { ++g_tokenizer.LexemeCurrent; }
+
 static char TokenizerPeek(usz lookahead)
 {
 	if (g_tokenizer.LexemeCurrent + lookahead >= g_tokenizer.SourceEnd) {
@@ -108,266 +208,322 @@ static bool TokenizerMatch(char expected)
 	return true;
 }
 
-// TODO: Make this function not trash
-static void TokenizerAddToken(TokenType type, const SymbolView* lexeme, f64 number, const MxShape* matrixShape)
+static Result TokenBufferExpand(TokenBuffer* tokens, usz capacity)
 {
-	if (type == TokenEof) {
-		g_tokenizer.LookaheadToken.Loc.LinePos = (usz)(g_tokenizer.SourceEnd - g_source.Lines[g_tokenizer.SourceLine - 1] + 1);
-	} else {
-		g_tokenizer.LookaheadToken.Loc.LinePos = g_tokenizer.SourceLinePos - (usz)(g_tokenizer.LexemeCurrent - g_tokenizer.LexemeStart);
+	TokenType* types = (TokenType*)realloc((void*)tokens->Types, capacity * sizeof(TokenType));
+	if (!types) {
+		return ResOutOfMemory;
 	}
+	tokens->Types = types;
 
-	g_tokenizer.LookaheadToken.Loc.Line = g_tokenizer.SourceLine;
-	g_tokenizer.LookaheadToken.Type = type;
-
-	if (type == TokenNumber) {
-		g_tokenizer.LookaheadToken.Number = number;
-	} else if (type == TokenIdentifier) {
-		g_tokenizer.LookaheadToken.Lexeme = *lexeme;
-	} else if (type == TokenMatrixShape) {
-		g_tokenizer.LookaheadToken.MatrixShape = *matrixShape;
+	TokenValue* values = (TokenValue*)realloc((void*)tokens->Values, capacity * sizeof(TokenValue));
+	if (!values) {
+		return ResOutOfMemory;
 	}
-}
+	tokens->Values = values;
 
-inline static void TokenizerSkipDigit()
-{
-	while (isdigit(TokenizerPeek(0))) {
-		TokenizerAdvance();
+	SourceLoc* locs = (SourceLoc*)realloc((void*)tokens->Locs, capacity * sizeof(SourceLoc));
+	if (!locs) {
+		return ResOutOfMemory;
 	}
+	tokens->Locs = locs;
+
+	tokens->Capacity = capacity;
+
+	return ResOk;
 }
 
-inline static void TokenizerSkipAlphanumeric()
+// Appends a token starting at the current lexeme and returns the slot for its value
+static TokenValue* TokenizerAddToken(TokenType type)
 {
-	while (isalnum(TokenizerPeek(0))) {
-		TokenizerAdvance();
+	TokenBuffer* tokens = &g_tokenizer.Tokens;
+	if (tokens->Count >= tokens->Capacity) {
+		DIAG_PANIC_ON_ERR(TokenBufferExpand(tokens, tokens->Capacity * 2));
 	}
-}
 
-void TokenizerInit()
-{
-	DIAG_PANIC_ON_ERR(SymbolTableInit(&g_tokenizer.TableIdentifiers));
+	usz i = tokens->Count++;
+	tokens->Types[i] = type;
+	tokens->Locs[i].Offset = (u32)(g_tokenizer.LexemeStart - g_source.Source);
 
-	g_tokenizer.SourceEnd = g_source.Source + g_source.SourceLength;
-	g_tokenizer.SourceLine = 1;
-	g_tokenizer.SourceLinePos = 1;
-	g_tokenizer.LexemeStart = g_source.Source;
-	g_tokenizer.LexemeCurrent = g_source.Source;
+	return &tokens->Values[i];
+}
+
+inline static void TokenizerSkipDigit() { g_tokenizer.LexemeCurrent = SkipDigits(g_tokenizer.LexemeCurrent, g_tokenizer.SourceEnd); }
 
-	g_source.Lines[0] = g_source.Source;
+inline static void TokenizerSkipAlphanumeric()
+{
+	g_tokenizer.LexemeCurrent = SkipAlphanumeric(g_tokenizer.LexemeCurrent, g_tokenizer.SourceEnd);
 }
 
 static void TokenizerSkipWhiteSpace()
 {
-	while (true) {
-		char c = TokenizerPeek(0);
-
-		switch (c) {
-		case '#':
-			while (TokenizerPeek(0) != '\0' && TokenizerPeek(0) != '\n') {
-				TokenizerAdvance();
+	const char* iter = g_tokenizer.LexemeCurrent;
+	const char* end = g_tokenizer.SourceEnd;
+
+	while (iter < end) {
+#ifdef MX_SSE2
+		if (end - iter >= 16) {
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)iter);
+			u32 rest = ~MaskWhiteSpace(chunk) & 0xFFFF;
+			iter += rest ? CountTrailingZeros(rest) : 16;
+			if (!rest) {
+				continue;
 			}
-			break;
-		case ' ':
-		case '\r':
-		case '\t':
-			break;
-		case '\n':
-			g_source.Lines[g_tokenizer.SourceLine] = g_tokenizer.LexemeCurrent + 1;
+		}
+#endif
 
-			g_tokenizer.SourceLinePos = 0;
-			++g_tokenizer.SourceLine;
+		char c = *iter;
+		if (c == '#') {
+			const char* newLine = (const char*)memchr(iter, '\n', (usz)(end - iter));
+			iter = newLine ? newLine : end;
+			continue;
+		}
 
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
 			break;
-		default:
-			return;
 		}
 
-		TokenizerAdvance();
+		++iter;
 	}
-}
 
-Token* TokenizerPeekToken()
-{
-	if (!g_tokenizer.HasLookahead) {
-		Token* token = TokenizerNextToken();
-		g_tokenizer.HasLookahead = true;
-		return token;
-	}
-
-	return &g_tokenizer.LookaheadToken;
+	g_tokenizer.LexemeCurrent = iter;
 }
 
-Token* TokenizerNextToken()
+static void TokenizerScanToken()
 {
-	if (g_tokenizer.HasLookahead) {
-		g_tokenizer.HasLookahead = false;
-		return &g_tokenizer.LookaheadToken;
-	}
-
-	TokenizerSkipWhiteSpace();
-
-	if (g_tokenizer.LexemeCurrent >= g_tokenizer.SourceEnd) {
-		TokenizerAddToken(TokenEof, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
-	}
-
-	g_tokenizer.LexemeStart = g_tokenizer.LexemeCurrent;
-
 	char c = TokenizerConsume();
 
 	switch (c) {
 	case '(':
-		TokenizerAddToken(TokenLeftRoundBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenLeftRoundBracket);
+		return;
 	case ')':
-		TokenizerAddToken(TokenRightRoundBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenRightRoundBracket);
+		return;
 	case '[':
-		TokenizerAddToken(TokenLeftSquareBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenLeftSquareBracket);
+		return;
 	case ']':
-		TokenizerAddToken(TokenRightSquareBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenRightSquareBracket);
+		return;
 	case '<':
 		if (TokenizerMatch('=')) {
-			TokenizerAddToken(TokenLessEqual, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenLessEqual);
 		} else if (TokenizerMatch('<')) {
-			TokenizerAddToken(TokenLeftVectorBracket, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenLeftVectorBracket);
 		} else {
-			TokenizerAddToken(TokenLess, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenLess);
 		}
-		return &g_tokenizer.LookaheadToken;
+		return;
 	case '>':
 		if (TokenizerMatch('=')) {
-			TokenizerAddToken(TokenGreaterEqual, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenGreaterEqual);
 		} else if (TokenizerMatch('>')) {
-			TokenizerAddToken(TokenRightVectorBracket, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenRightVectorBracket);
 		} else {
-			TokenizerAddToken(TokenGreater, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenGreater);
 		}
-		return &g_tokenizer.LookaheadToken;
+		return;
 	case '{':
-		TokenizerAddToken(TokenLeftCurlyBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenLeftCurlyBracket);
+		return;
 	case '}':
-		TokenizerAddToken(TokenRightCurlyBracket, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenRightCurlyBracket);
+		return;
 	case ',':
-		TokenizerAddToken(TokenComma, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenComma);
+		return;
 	case '+':
-		TokenizerAddToken(TokenAdd, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenAdd);
+		return;
 	case '-':
-		TokenizerAddToken(TokenSubtract, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenSubtract);
+		return;
 	case '*':
-		TokenizerAddToken(TokenMultiply, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenMultiply);
+		return;
 	case '/':
-		TokenizerAddToken(TokenDivide, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenDivide);
+		return;
+	case '.':
+		if (TokenizerMatch('*')) {
+			TokenizerAddToken(TokenElementMultiply);
+		} else if (TokenizerMatch('/')) {
+			TokenizerAddToken(TokenElementDivide);
+		} else if (TokenizerMatch('<')) {
+			if (TokenizerMatch('=')) {
+				TokenizerAddToken(TokenElementLessEqual);
+			} else {
+				TokenizerAddToken(TokenElementLess);
+			}
+		} else if (TokenizerMatch('>')) {
+			if (TokenizerMatch('=')) {
+				TokenizerAddToken(TokenElementGreaterEqual);
+			} else {
+				TokenizerAddToken(TokenElementGreater);
+			}
+		} else if (TokenizerPeek(0) == '=' && TokenizerPeek(1) == '=') {
+			TokenizerAdvance();
+			TokenizerAdvance();
+			TokenizerAddToken(TokenElementEqualEqual);
+		} else if (TokenizerPeek(0) == '!' && TokenizerPeek(1) == '=') {
+			TokenizerAdvance();
+			TokenizerAdvance();
+			TokenizerAddToken(TokenElementNotEqual);
+		} else {
+			TokenizerAddToken((TokenType)c);
+		}
+		return;
 	case '^':
-		TokenizerAddToken(TokenToPower, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenToPower);
+		return;
 	case '\'':
-		TokenizerAddToken(TokenTranspose, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenTranspose);
+		return;
 	case ':':
-		TokenizerAddToken(TokenColon, nullptr, 0, nullptr);
-		return &g_tokenizer.LookaheadToken;
+		TokenizerAddToken(TokenColon);
+		return;
 	case '=':
 		if (TokenizerMatch('=')) {
-			TokenizerAddToken(TokenEqualEqual, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenEqualEqual);
 		} else {
-			TokenizerAddToken(TokenEqual, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenEqual);
 		}
-		return &g_tokenizer.LookaheadToken;
+		return;
 	case '!':
 		if (TokenizerMatch('=')) {
-			TokenizerAddToken(TokenNotEqual, nullptr, 0, nullptr);
+			TokenizerAddToken(TokenNotEqual);
 		} else {
-			TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
+			TokenizerAddToken((TokenType)TokenizerPeek(0));
 		}
-		return &g_tokenizer.LookaheadToken;
+		return;
 	default:
-		if (isdigit(c)) {
-			while (isdigit(TokenizerPeek(0))) {
-				TokenizerAdvance();
-			}
+		if (IsDigit(c)) {
+			TokenizerSkipDigit();
 
 			if (TokenizerMatch('x')) {
-				if (!isdigit(TokenizerPeek(0))) {
-					TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
-					return &g_tokenizer.LookaheadToken;
+				if (!IsDigit(TokenizerPeek(0))) {
+					TokenizerAddToken((TokenType)TokenizerPeek(0));
+					return;
 				}
 
 				TokenizerSkipDigit();
 
-				if (isalpha(TokenizerPeek(0))) {
-					TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
-					return &g_tokenizer.LookaheadToken;
+				if (IsAlpha(TokenizerPeek(0))) {
+					TokenizerAddToken((TokenType)TokenizerPeek(0));
+					return;
 				}
 
 				usz lexemeLength = (usz)(g_tokenizer.LexemeCurrent - g_tokenizer.LexemeStart);
 				MxShape shape = ParseMatrixShape(g_tokenizer.LexemeStart, lexemeLength);
-				TokenizerAddToken(TokenMatrixShape, nullptr, 0, &shape);
-			} else if (TokenizerMatch('.')) {
-				if (!isdigit(TokenizerPeek(0))) {
-					TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
-					return &g_tokenizer.LookaheadToken;
-				}
-
+				TokenizerAddToken(TokenMatrixShape)->MatrixShape = shape;
+			} else if (TokenizerPeek(0) == '.' && IsDigit(TokenizerPeek(1))) {
+				// Without a digit after it the dot starts an operator, as in `2.*A`
+				TokenizerMatch('.');
 				TokenizerSkipDigit();
 
-				if (isalpha(TokenizerPeek(0))) {
-					TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
-					return &g_tokenizer.LookaheadToken;
+				if (IsAlpha(TokenizerPeek(0))) {
+					TokenizerAddToken((TokenType)TokenizerPeek(0));
+					return;
 				}
 
 				usz lexemeLength = (usz)(g_tokenizer.LexemeCurrent - g_tokenizer.LexemeStart);
-				TokenizerAddToken(TokenNumber, nullptr, ParseDouble(g_tokenizer.LexemeStart, lexemeLength), nullptr);
-			} else if (isalpha(TokenizerPeek(0))) {
-				TokenizerAddToken((TokenType)TokenizerPeek(0), nullptr, 0, nullptr);
-				return &g_tokenizer.LookaheadToken;
+				TokenizerAddToken(TokenNumber)->Number = ParseDouble(g_tokenizer.LexemeStart, lexemeLength);
+			} else if (IsAlpha(TokenizerPeek(0))) {
+				TokenizerAddToken((TokenType)TokenizerPeek(0));
+				return;
 			} else {
 				usz lexemeLength = (usz)(g_tokenizer.LexemeCurrent - g_tokenizer.LexemeStart);
-				TokenizerAddToken(TokenNumber, nullptr, ParseDouble(g_tokenizer.LexemeStart, lexemeLength), nullptr);
+				TokenizerAddToken(TokenNumber)->Number = ParseDouble(g_tokenizer.LexemeStart, lexemeLength);
 			}
-			return &g_tokenizer.LookaheadToken;
-		} else if (isalpha(c)) {
+			return;
+		} else if (IsAlpha(c)) {
 			TokenizerSkipAlphanumeric();
 
 			usz lexemeLength = (usz)(g_tokenizer.LexemeCurrent - g_tokenizer.LexemeStart);
 
-			if (lexemeLength == 3 && memcmp(g_tokenizer.LexemeStart, "let", lexemeLength) == 0) {
-				TokenizerAddToken(TokenLet, nullptr, 0, nullptr);
-			} else if (lexemeLength == 5 && memcmp(g_tokenizer.LexemeStart, "const", lexemeLength) == 0) {
-				TokenizerAddToken(TokenConst, nullptr, 0, nullptr);
-			} else if (lexemeLength == 2 && memcmp(g_tokenizer.LexemeStart, "if", lexemeLength) == 0) {
-				TokenizerAddToken(TokenIf, nullptr, 0, nullptr);
-			} else if (lexemeLength == 4 && memcmp(g_tokenizer.LexemeStart, "else", lexemeLength) == 0) {
-				TokenizerAddToken(TokenElse, nullptr, 0, nullptr);
-			} else if (lexemeLength == 5 && memcmp(g_tokenizer.LexemeStart, "while", lexemeLength) == 0) {
-				TokenizerAddToken(TokenWhile, nullptr, 0, nullptr);
-			} else if (lexemeLength == 3 && memcmp(g_tokenizer.LexemeStart, "and", lexemeLength) == 0) {
-				TokenizerAddToken(TokenAnd, nullptr, 0, nullptr);
-			} else if (lexemeLength == 2 && memcmp(g_tokenizer.LexemeStart, "or", lexemeLength) == 0) {
-				TokenizerAddToken(TokenOr, nullptr, 0, nullptr);
+			TokenType keyword = KeywordLookup(g_tokenizer.LexemeStart, lexemeLength);
+			if (keyword != TokenIdentifier) {
+				TokenizerAddToken(keyword);
 			} else {
 				SymbolView lexeme;
-				DIAG_PANIC_ON_ERR(SymbolTableAdd(&g_tokenizer.TableIdentifiers, g_tokenizer.LexemeStart, lexemeLength, &lexeme));
-				TokenizerAddToken(TokenIdentifier, &lexeme, 0, nullptr);
+				u64 hash = SymbolHash(g_tokenizer.LexemeStart, lexemeLength);
+				DIAG_PANIC_ON_ERR(SymbolTableAdd(&g_tokenizer.TableIdentifiers, g_tokenizer.LexemeStart, lexemeLength, hash, &lexeme));
+				TokenizerAddToken(TokenIdentifier)->Lexeme = lexeme;
 			}
 		} else {
-			TokenizerAddToken((TokenType)c, nullptr, 0, nullptr);
+			TokenizerAddToken((TokenType)c);
+		}
+
+		return;
+	}
+}
+
+static Token* TokenizerLoadToken(usz index)
+{
+	const TokenBuffer* tokens = &g_tokenizer.Tokens;
+	Token* token = &g_tokenizer.CurrentToken;
+
+	token->Type = tokens->Types[index];
+	token->Loc = tokens->Locs[index];
+
+	if (token->Type == TokenNumber) {
+		token->Number = tokens->Values[index].Number;
+	} else if (token->Type == TokenIdentifier) {
+		token->Lexeme = tokens->Values[index].Lexeme;
+	} else if (token->Type == TokenMatrixShape) {
+		token->MatrixShape = tokens->Values[index].MatrixShape;
+	}
+
+	return token;
+}
+
+void TokenizerInit()
+{
+	DIAG_PANIC_ON_ERR(SymbolTableInit(&g_tokenizer.TableIdentifiers));
+
+	g_tokenizer.SourceEnd = g_source.Source + g_source.SourceLength;
+	g_tokenizer.LexemeStart = g_source.Source;
+	g_tokenizer.LexemeCurrent = g_source.Source;
+	g_tokenizer.Cursor = 0;
+
+	// Most tokens span a few characters, the buffer grows if the guess is off
+	DIAG_PANIC_ON_ERR(TokenBufferExpand(&g_tokenizer.Tokens, g_source.SourceLength / 4 + 64));
+
+	while (true) {
+		TokenizerSkipWhiteSpace();
+
+		g_tokenizer.LexemeStart = g_tokenizer.LexemeCurrent;
+
+		if (g_tokenizer.LexemeCurrent >= g_tokenizer.SourceEnd) {
+			TokenizerAddToken(TokenEof);
+			break;
 		}
 
-		return &g_tokenizer.LookaheadToken;
+		TokenizerScanToken();
+	}
+}
+
+Token* TokenizerPeekToken() { return TokenizerLoadToken(g_tokenizer.Cursor); }
+
+Token* TokenizerNextToken()
+{
+	Token* token = TokenizerLoadToken(g_tokenizer.Cursor);
+
+	// The trailing Eof keeps being returned once reached
+	if (g_tokenizer.Cursor + 1 < g_tokenizer.Tokens.Count) {
+		++g_tokenizer.Cursor;
 	}
+
+	return token;
 }
 
 void TokenizerDeinit()
 {
+	free((void*)g_tokenizer.Tokens.Locs);
+	free((void*)g_tokenizer.Tokens.Values);
+	free((void*)g_tokenizer.Tokens.Types);
+	g_tokenizer.Tokens = (TokenBuffer) { 0 };
+
 	DIAG_PANIC_ON_ERR(SymbolTableDeinit(&g_tokenizer.TableIdentifiers));
 }
@@ -8,56 +8,62 @@
 
 TypeChecker g_typeChecker = { 0 };
 
-static usz GetSymbolID()
+static void BindingEnterScope()
 {
-	static usz id = 0;
-	return id++;
+	DIAG_PANIC_ON_ERR(DynArrayPush(&g_typeChecker.BindingScopes, &g_typeChecker.Bindings.Count));
 }
 
-static void BindingEnterScope()
+static Result BindingExitScope()
 {
-	BindingScope* temp = g_typeChecker.CurBindingScope;
+	usz* scopeStart = DynArrayAt(&g_typeChecker.BindingScopes, g_typeChecker.BindingScopes.Count - 1);
+	BindingEntry* bindings = (BindingEntry*)(void*)g_typeChecker.Bindings.Items;
 
-	DIAG_PANIC_ON_ERR(DynArenaAllocZeroed(
-		&g_typeChecker.BindingArena, (void**)&g_typeChecker.CurBindingScope, sizeof(BindingScope) + (64 * sizeof(BindingEntry))));
+	// Every name declared in the scope gets its shadowed binding back
+	for (usz i = g_typeChecker.Bindings.Count; i > *scopeStart; --i) {
+		SymbolTableEntryOf(bindings[i - 1].InternedName)->Binding = bindings[i - 1].Shadowed;
+	}
 
-	g_typeChecker.CurBindingScope->Parent = temp;
+	Result result = DynArrayTruncate(&g_typeChecker.Bindings, *scopeStart);
+	if (result) {
+		return result;
+	}
+
+	return DynArrayTruncate(&g_typeChecker.BindingScopes, g_typeChecker.BindingScopes.Count - 1);
 }
 
-static Result BindingExitScope()
+static Result BindingLookup(const char* name, usz* id)
 {
-	g_typeChecker.CurBindingScope = g_typeChecker.CurBindingScope->Parent;
+	usz binding = SymbolTableEntryOf(name)->Binding;
+	if (!binding) {
+		return ResNotFound;
+	}
+
+	*id = ((BindingEntry*)DynArrayAt(&g_typeChecker.Bindings, binding - 1))->ID;
 	return ResOk;
 }
 
-static Result BindingLookup(BindingScope* scope, const char* name, usz* id)
+static Result BindingInsert(const char* name, usz* id)
 {
-	for (usz i = 0; i < scope->EntryCount; ++i) {
-		if (scope->Entries[i].InternedName == name) {
-			*id = scope->Entries[i].ID;
-			return ResOk;
-		}
-	}
+	SymbolTableEntry* symbol = SymbolTableEntryOf(name);
+	usz scopeStart = *(usz*)DynArrayAt(&g_typeChecker.BindingScopes, g_typeChecker.BindingScopes.Count - 1);
 
-	if (!scope->Parent) {
-		return ResNotFound;
+	if (symbol->Binding > scopeStart) {
+		return ResInvalidParams;
 	}
 
-	return BindingLookup(scope->Parent, name, id);
-}
+	// A variable's slot is its depth in the binding stack, so variables of scopes that already ended get their slots reused
+	*id = g_typeChecker.Bindings.Count;
+	if (*id + 1 > g_typeChecker.VarSlotCount) {
+		g_typeChecker.VarSlotCount = *id + 1;
+	}
 
-static Result BindingInsert(BindingScope* scope, const char* name, usz* id)
-{
-	for (usz i = 0; i < scope->EntryCount; ++i) {
-		if (scope->Entries[i].InternedName == name) {
-			return ResInvalidParams;
-		}
+	BindingEntry entry = { .InternedName = name, .ID = *id, .Shadowed = symbol->Binding };
+	Result result = DynArrayPush(&g_typeChecker.Bindings, &entry);
+	if (result) {
+		return result;
 	}
 
-	*id = GetSymbolID();
-	scope->Entries[scope->EntryCount].ID = *id;
-	scope->Entries[scope->EntryCount].InternedName = name;
-	++scope->EntryCount;
+	symbol->Binding = g_typeChecker.Bindings.Count;
 	return ResOk;
 }
 
@@ -70,7 +76,7 @@ static void SymbolBind(ASTNode* node)
 	switch (node->Type) {
 	case ASTNodeMxLiteral: {
 		for (usz i = 0; i < node->MxLiteral.Shape.Height * node->MxLiteral.Shape.Width; ++i) {
-			SymbolBind(node->MxLiteral.Matrix[i]);
+			SymbolBind(ASTNodeChild(node->MxLiteral.FirstElement, i));
 		}
 
 		break;
@@ -79,88 +85,93 @@ static void SymbolBind(ASTNode* node)
 		BindingEnterScope();
 
 		for (usz i = 0; i < node->Block.NodeCount; ++i) {
-			SymbolBind(node->Block.Nodes[i]);
+			SymbolBind(ASTNodeChild(node->Block.FirstNode, i));
 		}
 
 		DIAG_PANIC_ON_ERR(BindingExitScope());
 		break;
 	}
 	case ASTNodeUnary:
-		SymbolBind(node->Unary.Operand);
+		SymbolBind(ASTNodeGet(node->Unary.Operand));
 		break;
 	case ASTNodeGrouping:
-		SymbolBind(node->Grouping.Expression);
+		SymbolBind(ASTNodeGet(node->Grouping.Expression));
 		break;
 	case ASTNodeBinary: {
-		SymbolBind(node->Binary.Left);
-		SymbolBind(node->Binary.Right);
+		SymbolBind(ASTNodeGet(node->Binary.Left));
+		SymbolBind(ASTNodeGet(node->Binary.Right));
 		break;
 	}
 	case ASTNodeIfStmt: {
-		SymbolBind(node->IfStmt.Condition);
-		SymbolBind(node->IfStmt.ThenBlock);
-		SymbolBind(node->IfStmt.ElseBlock);
+		SymbolBind(ASTNodeGet(node->IfStmt.Condition));
+		SymbolBind(ASTNodeGet(node->IfStmt.ThenBlock));
+		SymbolBind(ASTNodeGet(node->IfStmt.ElseBlock));
 		break;
 	}
 	case ASTNodeWhileStmt: {
-		SymbolBind(node->WhileStmt.Condition);
-		SymbolBind(node->WhileStmt.Body);
+		SymbolBind(ASTNodeGet(node->WhileStmt.Condition));
+		SymbolBind(ASTNodeGet(node->WhileStmt.Body));
 		break;
 	}
 	case ASTNodeVarDecl: {
 		usz newID;
-		Result result = BindingInsert(g_typeChecker.CurBindingScope, node->VarDecl.Identifier.Symbol, &newID);
+		Result result = BindingInsert(node->VarDecl.Identifier.Symbol, &newID);
 		if (result) {
 			DIAG_EMIT0(DiagRedeclarationInScope, node->Loc);
 			return;
 		}
 
-		node->VarDecl.ID = newID;
+		node->VarDecl.ID = (u32)newID;
 
-		SymbolBind(node->VarDecl.Expression);
+		SymbolBind(ASTNodeGet(node->VarDecl.Expression));
 
 		break;
 	}
 	case ASTNodeAssignment: {
 		usz id;
-		Result result = BindingLookup(g_typeChecker.CurBindingScope, node->Assignment.Identifier.Symbol, &id);
+		Result result = BindingLookup(node->Assignment.Identifier.Symbol, &id);
 		if (result) {
 			DIAG_EMIT(DiagUndeclaredVarUsed, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->Assignment.Identifier));
 			return;
 		}
 
-		node->Assignment.ID = id;
+		node->Assignment.ID = (u32)id;
 
-		SymbolBind(node->Assignment.Index);
+		SymbolBind(ASTNodeGet(node->Assignment.Index));
 
-		SymbolBind(node->Assignment.Expression);
+		SymbolBind(ASTNodeGet(node->Assignment.Expression));
 
 		break;
 	}
 	case ASTNodeFunctionCall: {
 		for (usz i = 0; i < node->FnCall.ArgCount; ++i) {
-			SymbolBind(node->FnCall.CallArgs[i]);
+			SymbolBind(ASTNodeChild(node->FnCall.FirstArg, i));
 		}
 
 		break;
 	}
 	case ASTNodeIdentifier: {
 		usz id;
-		Result result = BindingLookup(g_typeChecker.CurBindingScope, node->Identifier.Identifier.Symbol, &id);
+		Result result = BindingLookup(node->Identifier.Identifier.Symbol, &id);
 		if (result) {
 			DIAG_EMIT(DiagUndeclaredVarUsed, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->Identifier.Identifier));
 			return;
 		}
 
-		node->Identifier.ID = id;
+		node->Identifier.ID = (u32)id;
 
-		SymbolBind(node->Identifier.Index);
+		SymbolBind(ASTNodeGet(node->Identifier.Index));
 
 		break;
 	}
 	case ASTNodeIndexSuffix: {
-		SymbolBind(node->IndexSuffix.I);
-		SymbolBind(node->IndexSuffix.J);
+		SymbolBind(ASTNodeGet(node->IndexSuffix.I));
+		SymbolBind(ASTNodeGet(node->IndexSuffix.J));
+		break;
+	}
+	case ASTNodeRange: {
+		SymbolBind(ASTNodeGet(node->Range.Start));
+		SymbolBind(ASTNodeGet(node->Range.End));
 		break;
 	}
 	default:
@@ -168,167 +179,276 @@ static void SymbolBind(ASTNode* node)
 	}
 }
 
-Result TypeCheckCompTimeInteger(ASTNode* node, usz* num)
+// Reads an integer written as a 1x1 literal, `notCompTime` is reported for anything else. The caller checks its range
+static Result TypeCheckCompTimeNumber(ASTNode* node, DiagType notCompTime, f64* value)
 {
-	if (node->Type != ASTNodeMxLiteral || node->MxLiteral.Shape.Height != 1 || node->MxLiteral.Shape.Width != 1
-		|| node->MxLiteral.Matrix[0]->Type != ASTNodeNumber) {
-		DIAG_EMIT0(DiagFnCallArgMustBeCompTime, node->Loc);
+	if (node->Type != ASTNodeNumber || node->Number.Shape.Height != 1 || node->Number.Shape.Width != 1) {
+		DIAG_EMIT0(notCompTime, node->Loc);
 		return ResInvalidToken;
 	}
 
-	if (!IsF64Int(node->MxLiteral.Matrix[0]->Number)) {
+	*value = ASTNodeValues(node)[0];
+
+	if (!IsF64Int(*value)) {
 		DIAG_EMIT0(DiagNotInteger, node->Loc);
 		return ResInvalidToken;
 	}
 
-	if (node->MxLiteral.Matrix[0]->Number < 1) {
+	// Never evaluated, the value is read straight off the node
+	g_typeChecker.NodeShapes[ASTNodeIDOf(node)] = node->Number.Shape;
+	return ResOk;
+}
+
+Result TypeCheckCompTimeInteger(ASTNode* node, usz* num)
+{
+	f64 value;
+	Result result = TypeCheckCompTimeNumber(node, DiagFnCallArgMustBeCompTime, &value);
+	if (result) {
+		return result;
+	}
+
+	if (value < 1) {
 		DIAG_EMIT0(DiagInvalidInput, node->Loc);
 		return ResInvalidToken;
 	}
 
-	*num = (usz)node->MxLiteral.Matrix[0]->Number;
+	*num = (usz)value;
 	return ResOk;
 }
 
-MxShape* TypeCheck(ASTNode* node)
+static Result TypeCheckReductionDim(ASTNode* node, usz* dim)
 {
-	if (!node) {
-		return nullptr;
+	f64 value;
+	Result result = TypeCheckCompTimeNumber(node, DiagFnCallArgMustBeCompTime, &value);
+	if (result) {
+		return result;
 	}
 
-	switch (node->Type) {
-	case ASTNodeNumber: {
-		MxShape* shape;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+	if (value != 1 && value != 2) {
+		DIAG_EMIT0(DiagInvalidReductionDim, node->Loc);
+		return ResInvalidToken;
+	}
 
+	*dim = (usz)value;
+	return ResOk;
+}
+
+static void TypeCheckReductionShape(const MxShape* argShape, usz dim, MxShape* shape)
+{
+	switch (dim) {
+	case 1:
 		shape->Height = 1;
+		shape->Width = argShape->Width;
+		break;
+	case 2:
+		shape->Height = argShape->Height;
 		shape->Width = 1;
-		return shape;
+		break;
+	default:
+		shape->Height = 1;
+		shape->Width = 1;
+		break;
 	}
-	case ASTNodeMxLiteral: {
-		MxShape* shape;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+}
 
-		*shape = node->MxLiteral.Shape;
+static MxShape TypeCheck(ASTNode* node);
+
+// Checks a single dimension of an index suffix and computes how many rows/columns it selects. Ranges must have compile-time
+// bounds, so that the shape of a slice is always known statically
+static Result TypeCheckIndex(ASTNode* index, usz dimSize, usz* count)
+{
+	if (index->Type != ASTNodeRange) {
+		MxShape shape = TypeCheck(index);
+		if (!HasValue(shape)) {
+			DIAG_EMIT0(DiagExprDoesNotReturnValue, index->Loc);
+			return ResInvalidToken;
+		}
+
+		if (shape.Height != 1 || shape.Width != 1) {
+			DIAG_EMIT0(DiagMxLiteralOnly1x1, index->Loc);
+			return ResInvalidToken;
+		}
+
+		*count = 1;
+		return ResOk;
+	}
+
+	if (!index->Range.Start) {
+		*count = dimSize;
+		return ResOk;
+	}
+
+	f64 start;
+	Result result = TypeCheckCompTimeNumber(ASTNodeGet(index->Range.Start), DiagSliceBoundMustBeCompTime, &start);
+	if (result) {
+		return result;
+	}
+
+	f64 end;
+	result = TypeCheckCompTimeNumber(ASTNodeGet(index->Range.End), DiagSliceBoundMustBeCompTime, &end);
+	if (result) {
+		return result;
+	}
+
+	// Literals can be negative, so the bounds are compared before they are made sizes
+	if (start < 1 || start > end || end > (f64)dimSize) {
+		DIAG_EMIT(DiagInvalidSlice, index->Loc, DIAG_ARG_NUMBER(start), DIAG_ARG_NUMBER(end), DIAG_ARG_SIZE(dimSize));
+		return ResInvalidToken;
+	}
+
+	*count = (usz)end - (usz)start + 1;
+	return ResOk;
+}
+
+// Computes the shape of the part of a variable selected by an index suffix. A missing column index selects whole rows
+static Result TypeCheckIndexSuffix(ASTNode* indexSuffix, const MxShape* varShape, MxShape* shape)
+{
+	Result result = TypeCheckIndex(ASTNodeGet(indexSuffix->IndexSuffix.I), varShape->Height, &shape->Height);
+	if (result) {
+		return result;
+	}
+
+	if (!indexSuffix->IndexSuffix.J) {
+		shape->Width = varShape->Width;
+		return ResOk;
+	}
+
+	return TypeCheckIndex(ASTNodeGet(indexSuffix->IndexSuffix.J), varShape->Width, &shape->Width);
+}
+
+// Computes the shape of the value a node evaluates to, NO_SHAPE when it does not produce one
+static MxShape TypeCheckNode(ASTNode* node)
+{
+	if (!node) {
+		return NO_SHAPE;
+	}
+
+	switch (node->Type) {
+	case ASTNodeNumber:
+		return node->Number.Shape;
+	case ASTNodeMxLiteral: {
+		MxShape shape = node->MxLiteral.Shape;
 
 		for (usz i = 0; i < node->MxLiteral.Shape.Height * node->MxLiteral.Shape.Width; ++i) {
-			MxShape* mx = TypeCheck(node->MxLiteral.Matrix[i]);
+			MxShape mx = TypeCheck(ASTNodeChild(node->MxLiteral.FirstElement, i));
 
-			if (!mx) {
-				if (node->MxLiteral.Matrix[i]) {
-					DIAG_EMIT0(DiagExprDoesNotReturnValue, node->MxLiteral.Matrix[i]->Loc);
+			if (!HasValue(mx)) {
+				if (ASTNodeChild(node->MxLiteral.FirstElement, i)) {
+					DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeChild(node->MxLiteral.FirstElement, i)->Loc);
 				}
 
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			if (mx->Height != 1 || mx->Width != 1) {
-				DIAG_EMIT0(DiagMxLiteralOnly1x1, node->MxLiteral.Matrix[i]->Loc);
-				return nullptr;
+			if (mx.Height != 1 || mx.Width != 1) {
+				DIAG_EMIT0(DiagMxLiteralOnly1x1, ASTNodeChild(node->MxLiteral.FirstElement, i)->Loc);
+				return NO_SHAPE;
 			}
 		}
 
 		return shape;
 	}
 	case ASTNodeUnary: {
-		MxShape* shape;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+		MxShape shape;
 
-		MxShape* operand = TypeCheck(node->Unary.Operand);
-		if (!operand) {
+		MxShape operand = TypeCheck(ASTNodeGet(node->Unary.Operand));
+		if (!HasValue(operand)) {
 			if (node->Unary.Operand) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Unary.Operand->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->Unary.Operand)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
 		switch (node->Unary.Operator) {
 		case TokenSubtract:
-			*shape = *operand;
+			shape = operand;
 			break;
 		case TokenTranspose:
-			shape->Height = operand->Width;
-			shape->Width = operand->Height;
+			shape.Height = operand.Width;
+			shape.Width = operand.Height;
 			break;
 		default:
-			return nullptr;
+			return NO_SHAPE;
 		}
 		return shape;
 	}
 	case ASTNodeGrouping:
-		return TypeCheck(node->Grouping.Expression);
+		return TypeCheck(ASTNodeGet(node->Grouping.Expression));
 	case ASTNodeBinary: {
-		MxShape* shape;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+		MxShape shape;
 
-		MxShape* left = TypeCheck(node->Binary.Left);
-		if (!left) {
+		MxShape left = TypeCheck(ASTNodeGet(node->Binary.Left));
+		if (!HasValue(left)) {
 			if (node->Binary.Left) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Binary.Left->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->Binary.Left)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		MxShape* right = TypeCheck(node->Binary.Right);
-		if (!right) {
+		MxShape right = TypeCheck(ASTNodeGet(node->Binary.Right));
+		if (!HasValue(right)) {
 			if (node->Binary.Right) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Binary.Right->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->Binary.Right)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
 		switch (node->Binary.Operator) {
 		case TokenAdd:
 		case TokenSubtract:
-			if ((left->Height == right->Height && left->Width == right->Width) || (right->Height == 1 && right->Width == 1)) {
-				*shape = *left;
-				break;
-			} else if (left->Height == 1 && left->Width == 1) {
-				*shape = *right;
-				break;
-			} else {
-				DIAG_EMIT(DiagMxLiteralShapesDifferAddSub, node->Loc, DIAG_ARG_MX_SHAPE(*left), DIAG_ARG_MX_SHAPE(*right));
-				return nullptr;
+			if (!MxBroadcastShape(&left, &right, &shape)) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferAddSub, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
 			}
+
+			break;
+		case TokenElementMultiply:
+		case TokenElementDivide:
+			if (!MxBroadcastShape(&left, &right, &shape)) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferElementwise, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
+			}
+
+			break;
 		case TokenMultiply:
-			if (left->Width == right->Height) {
-				shape->Height = left->Height;
-				shape->Width = right->Width;
+			if (left.Width == right.Height) {
+				shape.Height = left.Height;
+				shape.Width = right.Width;
 				break;
-			} else if (left->Height == 1 && left->Width == 1) {
-				*shape = *right;
+			} else if (left.Height == 1 && left.Width == 1) {
+				shape = right;
 				break;
-			} else if (right->Height == 1 && right->Width == 1) {
-				*shape = *left;
+			} else if (right.Height == 1 && right.Width == 1) {
+				shape = left;
 				break;
 			} else {
-				DIAG_EMIT(DiagMxLiteralShapesDifferMul, node->Loc, DIAG_ARG_MX_SHAPE(*left), DIAG_ARG_MX_SHAPE(*right));
-				return nullptr;
+				DIAG_EMIT(DiagMxLiteralShapesDifferMul, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
 			}
 		case TokenDivide:
-			if (left->Height == 1 && left->Width == 1) {
-				*shape = *right;
+			if (left.Height == 1 && left.Width == 1) {
+				shape = right;
 				break;
-			} else if (right->Height == 1 && right->Width == 1) {
-				*shape = *left;
+			} else if (right.Height == 1 && right.Width == 1) {
+				shape = left;
 				break;
 			} else {
-				DIAG_EMIT(DiagMxLiteralShapesDifferDiv, node->Loc, DIAG_ARG_MX_SHAPE(*left), DIAG_ARG_MX_SHAPE(*right));
-				return nullptr;
+				DIAG_EMIT(DiagMxLiteralShapesDifferDiv, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
 			}
 		case TokenToPower:
-			if (right->Height != 1 || right->Width != 1) {
-				DIAG_EMIT0(DiagMxLiteralInvalidPower, node->Binary.Right->Loc);
-				return nullptr;
-			} else if (left->Height != left->Width) {
-				DIAG_EMIT0(DiagMxLiteralInvalidPowerBase, node->Binary.Left->Loc);
-				return nullptr;
+			if (right.Height != 1 || right.Width != 1) {
+				DIAG_EMIT0(DiagMxLiteralInvalidPower, ASTNodeGet(node->Binary.Right)->Loc);
+				return NO_SHAPE;
+			} else if (left.Height != left.Width) {
+				DIAG_EMIT0(DiagMxLiteralInvalidPowerBase, ASTNodeGet(node->Binary.Left)->Loc);
+				return NO_SHAPE;
 			}
 
-			*shape = *left;
+			shape = left;
 			break;
 		case TokenGreater:
 		case TokenGreaterEqual:
@@ -336,441 +456,414 @@ MxShape* TypeCheck(ASTNode* node)
 		case TokenLessEqual:
 		case TokenEqualEqual:
 		case TokenNotEqual:
-			if (left->Height != right->Height || left->Width != right->Width) {
-				DIAG_EMIT(DiagMxLiteralShapesDifferComp, node->Loc, DIAG_ARG_MX_SHAPE(*left), DIAG_ARG_MX_SHAPE(*right));
-				return nullptr;
+			if (left.Height != right.Height || left.Width != right.Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferComp, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
+			}
+
+			shape.Height = 1;
+			shape.Width = 1;
+			break;
+		case TokenElementGreater:
+		case TokenElementGreaterEqual:
+		case TokenElementLess:
+		case TokenElementLessEqual:
+		case TokenElementEqualEqual:
+		case TokenElementNotEqual:
+			if (!MxBroadcastShape(&left, &right, &shape)) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferComp, node->Loc, DIAG_ARG_MX_SHAPE(left), DIAG_ARG_MX_SHAPE(right));
+				return NO_SHAPE;
 			}
 
-			shape->Height = 1;
-			shape->Width = 1;
 			break;
 		case TokenOr:
 		case TokenAnd:
-			shape->Height = 1;
-			shape->Width = 1;
+			shape.Height = 1;
+			shape.Width = 1;
 			break;
 		default:
-			return nullptr;
+			return NO_SHAPE;
 		}
 
 		return shape;
 	}
 	case ASTNodeIfStmt: {
-		MxShape* condShape = TypeCheck(node->IfStmt.Condition);
-		if (!condShape) {
+		MxShape condShape = TypeCheck(ASTNodeGet(node->IfStmt.Condition));
+		if (!HasValue(condShape)) {
 			if (node->IfStmt.Condition) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->IfStmt.Condition->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->IfStmt.Condition)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		TypeCheck(node->IfStmt.ThenBlock);
+		TypeCheck(ASTNodeGet(node->IfStmt.ThenBlock));
 
 		if (node->IfStmt.ElseBlock) {
-			TypeCheck(node->IfStmt.ElseBlock);
+			TypeCheck(ASTNodeGet(node->IfStmt.ElseBlock));
 		}
 
-		return nullptr;
+		return NO_SHAPE;
 	}
 	case ASTNodeWhileStmt: {
-		MxShape* condShape = TypeCheck(node->WhileStmt.Condition);
-		if (!condShape) {
+		MxShape condShape = TypeCheck(ASTNodeGet(node->WhileStmt.Condition));
+		if (!HasValue(condShape)) {
 			if (node->WhileStmt.Condition) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->WhileStmt.Condition->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->WhileStmt.Condition)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		TypeCheck(node->WhileStmt.Body);
+		TypeCheck(ASTNodeGet(node->WhileStmt.Body));
 
-		return nullptr;
+		return NO_SHAPE;
 	}
 	case ASTNodeVarDecl: {
 		usz id = node->VarDecl.ID;
-		MxShape* initShape = TypeCheck(node->VarDecl.Expression);
+		MxShape initShape = TypeCheck(ASTNodeGet(node->VarDecl.Expression));
 
-		if (!initShape) {
+		if (!HasValue(initShape)) {
 			if (node->VarDecl.Expression) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->VarDecl.Expression->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->VarDecl.Expression)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		MxShape* varShape;
+		MxShape varShape;
 		if (!node->VarDecl.HasDeclaredShape) {
-			if (!initShape) {
-				DIAG_EMIT(DiagUninitializedUntypedVar, node->VarDecl.Expression->Loc, DIAG_ARG_SYMBOL_VIEW(node->VarDecl.Identifier));
-				return nullptr;
+			if (!HasValue(initShape)) {
+				DIAG_EMIT(DiagUninitializedUntypedVar, ASTNodeGet(node->VarDecl.Expression)->Loc,
+					DIAG_ARG_SYMBOL_VIEW(node->VarDecl.Identifier));
+				return NO_SHAPE;
 			}
 
 			varShape = initShape;
 		} else {
-			varShape = &node->VarDecl.Shape;
+			varShape = node->VarDecl.Shape;
 		}
 
-		g_typeChecker.TypeCheckingTable[id].Shape = *varShape;
+		g_typeChecker.TypeCheckingTable[id].Shape = varShape;
 		g_typeChecker.TypeCheckingTable[id].IsConst = node->VarDecl.IsConst;
-		node->VarDecl.Shape = *varShape;
+		node->VarDecl.Shape = varShape;
 
-		if (node->VarDecl.IsConst && !initShape) {
-			DIAG_EMIT(DiagUninitializedConstVar, node->VarDecl.Expression->Loc, DIAG_ARG_SYMBOL_VIEW(node->VarDecl.Identifier));
-			return nullptr;
+		if (node->VarDecl.IsConst && !HasValue(initShape)) {
+			DIAG_EMIT(DiagUninitializedConstVar, ASTNodeGet(node->VarDecl.Expression)->Loc, DIAG_ARG_SYMBOL_VIEW(node->VarDecl.Identifier));
+			return NO_SHAPE;
 		}
 
-		if (initShape) {
-			if (varShape->Height != initShape->Height || varShape->Width != initShape->Width) {
-				DIAG_EMIT(DiagMxLiteralShapesDifferAssign, node->VarDecl.Expression->Loc, DIAG_ARG_MX_SHAPE(*initShape),
-					DIAG_ARG_MX_SHAPE(*varShape));
-				return nullptr;
+		if (HasValue(initShape)) {
+			if (varShape.Height != initShape.Height || varShape.Width != initShape.Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferAssign, ASTNodeGet(node->VarDecl.Expression)->Loc, DIAG_ARG_MX_SHAPE(initShape),
+					DIAG_ARG_MX_SHAPE(varShape));
+				return NO_SHAPE;
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		return nullptr;
+		return NO_SHAPE;
 	}
 	case ASTNodeAssignment: {
 		usz id = node->Assignment.ID;
 
 		if (g_typeChecker.TypeCheckingTable[id].IsConst) {
 			DIAG_EMIT0(DiagAssignToConstVar, node->Loc);
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		MxShape* assignShape = TypeCheck(node->Assignment.Expression);
+		MxShape assignShape = TypeCheck(ASTNodeGet(node->Assignment.Expression));
 		MxShape* varShape = &g_typeChecker.TypeCheckingTable[id].Shape;
 
-		if (!assignShape) {
+		if (!HasValue(assignShape)) {
 			if (node->Assignment.Expression) {
-				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Assignment.Expression->Loc);
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeGet(node->Assignment.Expression)->Loc);
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
 		if (!node->Assignment.Index) {
-			if (varShape->Height != assignShape->Height || varShape->Width != assignShape->Width) {
-				DIAG_EMIT(DiagMxLiteralShapesDifferAssign, node->Assignment.Expression->Loc, DIAG_ARG_MX_SHAPE(*assignShape),
+			if (varShape->Height != assignShape.Height || varShape->Width != assignShape.Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferAssign, ASTNodeGet(node->Assignment.Expression)->Loc, DIAG_ARG_MX_SHAPE(assignShape),
 					DIAG_ARG_MX_SHAPE(*varShape));
-				return nullptr;
+				return NO_SHAPE;
 			}
 		} else {
-			MxShape* mxI = TypeCheck(node->Assignment.Index->IndexSuffix.I);
-			if (!mxI) {
-				if (node->Assignment.Index->IndexSuffix.I) {
-					DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Assignment.Index->IndexSuffix.I->Loc);
-				}
-
-				return nullptr;
-			}
-
-			if (mxI->Height != 1 || mxI->Width != 1) {
-				DIAG_EMIT0(DiagMxLiteralOnly1x1, node->Assignment.Index->IndexSuffix.I->Loc);
-				return nullptr;
+			MxShape sliceShape;
+			Result result = TypeCheckIndexSuffix(ASTNodeGet(node->Assignment.Index), varShape, &sliceShape);
+			if (result) {
+				return NO_SHAPE;
 			}
 
-			if (node->Assignment.Index->IndexSuffix.J) {
-				MxShape* mxJ = TypeCheck(node->Assignment.Index->IndexSuffix.J);
-				if (!mxJ) {
-					if (node->Assignment.Index->IndexSuffix.J) {
-						DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Assignment.Index->IndexSuffix.J->Loc);
-					}
-
-					return nullptr;
-				}
-
-				if (mxJ->Height != 1 || mxJ->Width != 1) {
-					DIAG_EMIT0(DiagMxLiteralOnly1x1, node->Assignment.Index->IndexSuffix.I->Loc);
-					return nullptr;
-				}
-
-				if (assignShape->Height != 1 || assignShape->Width != 1) {
-					MxShape correctShape = { .Height = 1, .Width = 1 };
-					DIAG_EMIT(DiagMxLiteralShapesDifferAssign, node->Assignment.Expression->Loc, DIAG_ARG_MX_SHAPE(*assignShape),
-						DIAG_ARG_MX_SHAPE(correctShape));
-					return nullptr;
-				}
-			} else {
-				if (assignShape->Height != 1 || assignShape->Width != varShape->Width) {
-					MxShape correctShape = { .Height = 1, .Width = varShape->Width };
-					DIAG_EMIT(DiagMxLiteralShapesDifferAssign, node->Assignment.Expression->Loc, DIAG_ARG_MX_SHAPE(*assignShape),
-						DIAG_ARG_MX_SHAPE(correctShape));
-					return nullptr;
-				}
+			if (assignShape.Height != sliceShape.Height || assignShape.Width != sliceShape.Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferAssign, ASTNodeGet(node->Assignment.Expression)->Loc, DIAG_ARG_MX_SHAPE(assignShape),
+					DIAG_ARG_MX_SHAPE(sliceShape));
+				return NO_SHAPE;
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
-		return nullptr;
+		return NO_SHAPE;
 	}
 	case ASTNodeFunctionCall: {
 		if (node->FnCall.Identifier.SymbolLength == 7 && memcmp(node->FnCall.Identifier.Symbol, "display", 7) == 0) {
 			for (usz i = 0; i < node->FnCall.ArgCount; ++i) {
-				MxShape* argShape = TypeCheck(node->FnCall.CallArgs[i]);
-				if (!argShape) {
-					if (node->FnCall.CallArgs[i]) {
-						DIAG_EMIT0(DiagExprDoesNotReturnValue, node->FnCall.CallArgs[i]->Loc);
+				MxShape argShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, i));
+				if (!HasValue(argShape)) {
+					if (ASTNodeChild(node->FnCall.FirstArg, i)) {
+						DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeChild(node->FnCall.FirstArg, i)->Loc);
 					}
 
-					return nullptr;
+					return NO_SHAPE;
 				}
 			}
 
-			return nullptr;
+			return NO_SHAPE;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "ident", 5) == 0) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz size;
-			Result result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[0], &size);
+			Result result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 0), &size);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = size;
-			shape->Width = size;
+			shape.Height = size;
+			shape.Width = size;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "diag", 4) == 0) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* arg = TypeCheck(node->FnCall.CallArgs[0]);
-			if (arg->Width != 1) {
-				DIAG_EMIT0(DiagFnCallArgMustBeVec, node->FnCall.CallArgs[0]->Loc);
-				return nullptr;
+			MxShape arg = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			if (arg.Width != 1) {
+				DIAG_EMIT0(DiagFnCallArgMustBeVec, ASTNodeChild(node->FnCall.FirstArg, 0)->Loc);
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = arg->Height;
-			shape->Width = arg->Height;
+			shape.Height = arg.Height;
+			shape.Width = arg.Height;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "rank", 4) == 0) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			TypeCheck(node->FnCall.CallArgs[0]);
+			TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = 1;
-			shape->Width = 1;
+			shape.Height = 1;
+			shape.Width = 1;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "inv", 3) == 0) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* arg = TypeCheck(node->FnCall.CallArgs[0]);
+			MxShape arg = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
 
-			if (arg->Height != arg->Width) {
-				DIAG_EMIT0(DiagFnCallArgMustBeSquare, node->FnCall.CallArgs[0]->Loc);
-				return nullptr;
+			if (arg.Height != arg.Width) {
+				DIAG_EMIT0(DiagFnCallArgMustBeSquare, ASTNodeChild(node->FnCall.FirstArg, 0)->Loc);
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = arg->Height;
-			shape->Width = arg->Height;
+			shape.Height = arg.Height;
+			shape.Width = arg.Height;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "det", 3) == 0) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* arg = TypeCheck(node->FnCall.CallArgs[0]);
+			MxShape arg = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
 
-			if (arg->Height != arg->Width) {
-				DIAG_EMIT0(DiagFnCallArgMustBeSquare, node->FnCall.CallArgs[0]->Loc);
-				return nullptr;
+			if (arg.Height != arg.Width) {
+				DIAG_EMIT0(DiagFnCallArgMustBeSquare, ASTNodeChild(node->FnCall.FirstArg, 0)->Loc);
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = 1;
-			shape->Width = 1;
+			shape.Height = 1;
+			shape.Width = 1;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "pow", 3) == 0) {
 			if (node->FnCall.ArgCount < 2) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 2) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* arg1 = TypeCheck(node->FnCall.CallArgs[0]);
-			MxShape* arg2 = TypeCheck(node->FnCall.CallArgs[1]);
+			MxShape arg1 = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			MxShape arg2 = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 1));
 
-			if (arg1->Height != arg2->Height || arg1->Width != arg2->Width) {
+			if (arg1.Height != arg2.Height || arg1.Width != arg2.Width) {
 				DIAG_EMIT0(DiagFnCallArgsMustBeEqualShape, node->Loc);
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			*shape = *arg1;
+			shape = arg1;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 7 && memcmp(node->FnCall.Identifier.Symbol, "reshape", 7) == 0) {
 			if (node->FnCall.ArgCount < 3) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 3) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			TypeCheck(node->FnCall.CallArgs[0]);
+			TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
 
 			usz height;
-			Result result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[1], &height);
+			Result result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 1), &height);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz width;
-			result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[2], &width);
+			result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 2), &width);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = height;
-			shape->Width = width;
+			shape.Height = height;
+			shape.Width = width;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "fill", 4) == 0) {
 			if (node->FnCall.ArgCount < 3) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 3) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz height;
-			Result result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[0], &height);
+			Result result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 0), &height);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz width;
-			result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[1], &width);
+			result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 1), &width);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* fillShape = TypeCheck(node->FnCall.CallArgs[2]);
-			if (fillShape->Height != 1 || fillShape->Width != 1) {
-				DIAG_EMIT0(DiagMxLiteralOnly1x1, node->FnCall.CallArgs[2]->Loc);
-				return nullptr;
+			MxShape fillShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 2));
+			if (fillShape.Height != 1 || fillShape.Width != 1) {
+				DIAG_EMIT0(DiagMxLiteralOnly1x1, ASTNodeChild(node->FnCall.FirstArg, 2)->Loc);
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = height;
-			shape->Width = width;
+			shape.Height = height;
+			shape.Width = width;
 			return shape;
 		}
 
 		if ((node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "rand", 4) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "randn", 5) == 0)
 			|| (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "input", 5) == 0)) {
 			if (node->FnCall.ArgCount < 2) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 2) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz height;
-			Result result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[0], &height);
+			Result result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 0), &height);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			usz width;
-			result = TypeCheckCompTimeInteger(node->FnCall.CallArgs[1], &width);
+			result = TypeCheckCompTimeInteger(ASTNodeChild(node->FnCall.FirstArg, 1), &width);
 			if (result) {
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = height;
-			shape->Width = width;
+			shape.Height = height;
+			shape.Width = width;
 			return shape;
 		}
 
@@ -785,116 +878,292 @@ MxShape* TypeCheck(ASTNode* node)
 			|| (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "ceil", 4) == 0)) {
 			if (node->FnCall.ArgCount < 1) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 1) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* argShape = TypeCheck(node->FnCall.CallArgs[0]);
+			MxShape argShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = argShape->Height;
-			shape->Width = argShape->Width;
+			shape.Height = argShape.Height;
+			shape.Width = argShape.Width;
 			return shape;
 		}
 
 		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "log", 3) == 0) {
 			if (node->FnCall.ArgCount < 2) {
 				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
+			}
+
+			if (node->FnCall.ArgCount > 2) {
+				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			MxShape baseShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			if (baseShape.Height != 1 || baseShape.Width != 1) {
+				DIAG_EMIT0(DiagMxLiteralOnly1x1, ASTNodeChild(node->FnCall.FirstArg, 0)->Loc);
+				return NO_SHAPE;
+			}
+
+			MxShape argShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 1));
+
+			MxShape shape;
+
+			shape.Height = argShape.Height;
+			shape.Width = argShape.Width;
+			return shape;
+		}
+
+		if ((node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "sum", 3) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "mean", 4) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "min", 3) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "max", 3) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 4 && memcmp(node->FnCall.Identifier.Symbol, "norm", 4) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "any", 3) == 0)
+			|| (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "all", 3) == 0)) {
+			if (node->FnCall.ArgCount < 1) {
+				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
 			}
 
 			if (node->FnCall.ArgCount > 2) {
 				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-				return nullptr;
+				return NO_SHAPE;
 			}
 
-			MxShape* baseShape = TypeCheck(node->FnCall.CallArgs[0]);
-			if (baseShape->Height != 1 || baseShape->Width != 1) {
-				DIAG_EMIT0(DiagMxLiteralOnly1x1, node->FnCall.CallArgs[0]->Loc);
-				return nullptr;
+			MxShape argShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			if (!HasValue(argShape)) {
+				if (ASTNodeChild(node->FnCall.FirstArg, 0)) {
+					DIAG_EMIT0(DiagExprDoesNotReturnValue, ASTNodeChild(node->FnCall.FirstArg, 0)->Loc);
+				}
+
+				return NO_SHAPE;
 			}
 
-			MxShape* argShape = TypeCheck(node->FnCall.CallArgs[1]);
+			usz dim = 0;
+			if (node->FnCall.ArgCount == 2) {
+				Result result = TypeCheckReductionDim(ASTNodeChild(node->FnCall.FirstArg, 1), &dim);
+				if (result) {
+					return NO_SHAPE;
+				}
+			}
 
-			MxShape* shape;
-			DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+			MxShape shape;
 
-			shape->Height = argShape->Height;
-			shape->Width = argShape->Width;
+			TypeCheckReductionShape(&argShape, dim, &shape);
 			return shape;
 		}
 
+		if (node->FnCall.Identifier.SymbolLength == 3 && memcmp(node->FnCall.Identifier.Symbol, "dot", 3) == 0) {
+			if (node->FnCall.ArgCount < 2) {
+				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			if (node->FnCall.ArgCount > 3) {
+				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			MxShape arg1 = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			MxShape arg2 = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 1));
+			if (!HasValue(arg1) || !HasValue(arg2)) {
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Loc);
+				return NO_SHAPE;
+			}
+
+			if (arg1.Height != arg2.Height || arg1.Width != arg2.Width) {
+				DIAG_EMIT0(DiagFnCallArgsMustBeEqualShape, node->Loc);
+				return NO_SHAPE;
+			}
+
+			usz dim = 0;
+			if (node->FnCall.ArgCount == 3) {
+				Result result = TypeCheckReductionDim(ASTNodeChild(node->FnCall.FirstArg, 2), &dim);
+				if (result) {
+					return NO_SHAPE;
+				}
+			}
+
+			MxShape shape;
+
+			TypeCheckReductionShape(&arg1, dim, &shape);
+			return shape;
+		}
+
+		if (node->FnCall.Identifier.SymbolLength == 5 && memcmp(node->FnCall.Identifier.Symbol, "where", 5) == 0) {
+			if (node->FnCall.ArgCount < 3) {
+				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			if (node->FnCall.ArgCount > 3) {
+				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			MxShape maskShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 0));
+			MxShape trueShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 1));
+			MxShape falseShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 2));
+			if (!HasValue(maskShape) || !HasValue(trueShape) || !HasValue(falseShape)) {
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Loc);
+				return NO_SHAPE;
+			}
+
+			MxShape valuesShape;
+			if (!MxBroadcastShape(&trueShape, &falseShape, &valuesShape)) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferElementwise, node->Loc, DIAG_ARG_MX_SHAPE(trueShape), DIAG_ARG_MX_SHAPE(falseShape));
+				return NO_SHAPE;
+			}
+
+			MxShape shape;
+
+			if (!MxBroadcastShape(&maskShape, &valuesShape, &shape)) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferElementwise, node->Loc, DIAG_ARG_MX_SHAPE(maskShape), DIAG_ARG_MX_SHAPE(valuesShape));
+				return NO_SHAPE;
+			}
+
+			return shape;
+		}
+
+		if (node->FnCall.Identifier.SymbolLength == 8 && memcmp(node->FnCall.Identifier.Symbol, "setwhere", 8) == 0) {
+			if (node->FnCall.ArgCount < 3) {
+				DIAG_EMIT(DiagTooLittleFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			if (node->FnCall.ArgCount > 3) {
+				DIAG_EMIT(DiagTooManyFunctionCallArgs, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
+				return NO_SHAPE;
+			}
+
+			ASTNode* var = ASTNodeChild(node->FnCall.FirstArg, 0);
+			if (!var || var->Type != ASTNodeIdentifier || ASTNodeGet(var->Identifier.Index)) {
+				DIAG_EMIT0(DiagFnCallArgMustBeVar, node->Loc);
+				return NO_SHAPE;
+			}
+
+			if (g_typeChecker.TypeCheckingTable[var->Identifier.ID].IsConst) {
+				DIAG_EMIT0(DiagAssignToConstVar, var->Loc);
+				return NO_SHAPE;
+			}
+
+			MxShape* varShape = &g_typeChecker.TypeCheckingTable[var->Identifier.ID].Shape;
+			MxShape maskShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 1));
+			MxShape valueShape = TypeCheck(ASTNodeChild(node->FnCall.FirstArg, 2));
+			if (!HasValue(maskShape) || !HasValue(valueShape)) {
+				DIAG_EMIT0(DiagExprDoesNotReturnValue, node->Loc);
+				return NO_SHAPE;
+			}
+
+			// Neither the mask nor the value may grow the variable
+			MxShape resultShape;
+			if (!MxBroadcastShape(&maskShape, varShape, &resultShape) || resultShape.Height != varShape->Height
+				|| resultShape.Width != varShape->Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferElementwise, ASTNodeChild(node->FnCall.FirstArg, 1)->Loc, DIAG_ARG_MX_SHAPE(maskShape),
+					DIAG_ARG_MX_SHAPE(*varShape));
+				return NO_SHAPE;
+			}
+
+			if (!MxBroadcastShape(&valueShape, varShape, &resultShape) || resultShape.Height != varShape->Height
+				|| resultShape.Width != varShape->Width) {
+				DIAG_EMIT(DiagMxLiteralShapesDifferElementwise, ASTNodeChild(node->FnCall.FirstArg, 2)->Loc, DIAG_ARG_MX_SHAPE(valueShape),
+					DIAG_ARG_MX_SHAPE(*varShape));
+				return NO_SHAPE;
+			}
+
+			return NO_SHAPE;
+		}
+
 		DIAG_EMIT(DiagUndeclaredFunction, node->Loc, DIAG_ARG_SYMBOL_VIEW(node->FnCall.Identifier));
-		return nullptr;
+		return NO_SHAPE;
 	}
 	case ASTNodeIdentifier: {
-		MxShape* shape;
-		DIAG_PANIC_ON_ERR(StatArenaAlloc(&g_typeChecker.ShapeArena, (void**)&shape));
+		MxShape shape;
 
 		usz id = node->Identifier.ID;
 		MxShape* varShape = &g_typeChecker.TypeCheckingTable[id].Shape;
 
 		if (node->Identifier.Index) {
-			if (node->Identifier.Index->IndexSuffix.J) {
-				shape->Height = 1;
-				shape->Width = 1;
-				return shape;
+			Result result = TypeCheckIndexSuffix(ASTNodeGet(node->Identifier.Index), varShape, &shape);
+			if (result) {
+				return NO_SHAPE;
 			}
 
-			shape->Height = 1;
-			shape->Width = varShape->Width;
 			return shape;
 		}
 
-		shape->Height = varShape->Height;
-		shape->Width = varShape->Width;
+		shape.Height = varShape->Height;
+		shape.Width = varShape->Width;
 		return shape;
 	}
 	case ASTNodeBlock: {
 		for (usz i = 0; i < node->Block.NodeCount; ++i) {
-			MxShape* shape = TypeCheck(node->Block.Nodes[i]);
-			if (shape) {
-				DIAG_EMIT0(DiagUnusedExpressionResult, node->Block.Nodes[i]->Loc);
-				return nullptr;
+			MxShape shape = TypeCheck(ASTNodeChild(node->Block.FirstNode, i));
+			if (HasValue(shape)) {
+				DIAG_EMIT0(DiagUnusedExpressionResult, ASTNodeChild(node->Block.FirstNode, i)->Loc);
+				return NO_SHAPE;
 			}
 		}
 
-		return nullptr;
+		return NO_SHAPE;
 	}
 	default:
-		return nullptr;
+		return NO_SHAPE;
 	}
 }
 
-void TypeCheckerInit()
+// Also records the shape on the node, so later passes don't have to infer it again
+static MxShape TypeCheck(ASTNode* node)
 {
-	DIAG_PANIC_ON_ERR(DynArenaInit(&g_typeChecker.BindingArena));
+	MxShape shape = TypeCheckNode(node);
 
-	g_typeChecker.TypeCheckingTable = calloc(128, sizeof(MxShape));
-	if (!g_typeChecker.TypeCheckingTable) {
-		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	if (node) {
+		g_typeChecker.NodeShapes[ASTNodeIDOf(node)] = shape;
 	}
 
-	DIAG_PANIC_ON_ERR(StatArenaInit(&g_typeChecker.ShapeArena, sizeof(MxShape)));
+	return shape;
+}
+
+void TypeCheckerInit()
+{
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_typeChecker.Bindings, sizeof(BindingEntry)));
+
+	DIAG_PANIC_ON_ERR(DynArrayInit(&g_typeChecker.BindingScopes, sizeof(usz)));
 
-	g_typeChecker.CurBindingScope = nullptr;
 }
 
-void TypeCheckerSymbolBind() { SymbolBind((ASTNode*)g_parser.ASTArena.Blocks->Data); }
+void TypeCheckerSymbolBind() { SymbolBind(ASTNodeGet(g_parser.Root)); }
+
+void TypeCheckerTypeCheck()
+{
+	g_typeChecker.TypeCheckingTable = (TypeCheckingEntry*)calloc(g_typeChecker.VarSlotCount, sizeof(TypeCheckingEntry));
+	if (!g_typeChecker.TypeCheckingTable && g_typeChecker.VarSlotCount > 0) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
+
+	g_typeChecker.NodeShapes = (MxShape*)calloc(g_parser.Nodes.Count, sizeof(MxShape));
+	if (!g_typeChecker.NodeShapes) {
+		DIAG_PANIC_ON_ERR(ResOutOfMemory);
+	}
 
-void TypeCheckerTypeCheck() { TypeCheck((ASTNode*)g_parser.ASTArena.Blocks->Data); }
+	TypeCheck(ASTNodeGet(g_parser.Root));
+}
 
 void TypeCheckerDeinit()
 {
-	free(g_typeChecker.TypeCheckingTable);
+	free((void*)g_typeChecker.TypeCheckingTable);
+
+	free((void*)g_typeChecker.NodeShapes);
 
-	DIAG_PANIC_ON_ERR(StatArenaDeinit(&g_typeChecker.ShapeArena));
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_typeChecker.BindingScopes));
 
-	DIAG_PANIC_ON_ERR(DynArenaDeinit(&g_typeChecker.BindingArena));
+	DIAG_PANIC_ON_ERR(DynArrayDeinit(&g_typeChecker.Bindings));
 }